@@ -7,6 +7,10 @@
  * Level 1: Two "Cluster-Leaders" follow the Super-Leader in a fixed formation.
  * Level 0: Follower nodes within each cluster follow their respective Cluster-Leader.
  *
+ * The leader tree is configurable (--clusterFanout, --formationRadius): any
+ * number of clusters, and sub-clusters below them, each level holding a ring
+ * formation around its parent.
+ *
  * This creates a system where entire clusters move together (cluster-level mobility)
  * and individual nodes move within their cluster (node-level mobility).
  * Inter-cluster routing is handled by a dedicated backbone network for leaders using OLSR+HNA.
@@ -21,16 +25,56 @@
 #include "ns3/internet-module.h"
 #include "ns3/yans-wifi-channel.h"
 #include "ns3/yans-wifi-helper.h"
+#include "ns3/spectrum-wifi-helper.h"
+#include "ns3/spectrum-channel.h"
+#include "ns3/spectrum-phy.h"
+#include "ns3/spectrum-signal-parameters.h"
+#include "ns3/spectrum-propagation-loss-model.h"
+#include "ns3/antenna-model.h"
 #include "ns3/applications-module.h"
 #include "ns3/flow-monitor-module.h"
 #include "ns3/log.h"
 #include "ns3/olsr-helper.h"
 #include "ns3/olsr-routing-protocol.h"
+#include "ns3/aodv-module.h"
+#include "ns3/dsdv-module.h"
 #include "ns3/netanim-module.h"
 #include "ns3/ipv4.h"
 
+#include "MANET-Results.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <functional>
 #include <iomanip>
+#include <limits>
+#include <memory>
+#include <new>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include <cxxabi.h>
+#include <link.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 using namespace ns3;
 using namespace ns3::olsr;
@@ -40,43 +84,993 @@ using namespace ns3::olsr;
 //================================================================================
 NS_LOG_COMPONENT_DEFINE("HierarchicalMobilityMANET");
 
+// Profile that ProfilingScheduler reports to while a profiled run is executing.
+class EventProfile;
+static EventProfile* g_eventProfile = nullptr;
+
+#ifdef MANET_COUNT_ALLOCATIONS
+// Diagnostic build only (-DMANET_COUNT_ALLOCATIONS): number of global operator
+// new calls so far. Hot paths sample it before and after their work to show
+// whether they allocate; the simulator is single-threaded and workers are
+// separate processes, so a plain counter is enough.
+static uint64_t g_heapAllocations = 0;
+
+void* operator new(std::size_t size) {
+    ++g_heapAllocations;
+    if (void* p = std::malloc(size != 0 ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+#endif
+
 //================================================================================
-// 3. FUNCTION PROTOTYPES
+// 3. TYPES & FUNCTION PROTOTYPES
 //================================================================================
-void RunSimulation(uint32_t nodesPerCluster, double simulationTime, double areaSize, double followerSpeed, double noiseFactor, uint32_t packetSizei, uint32_t runNumber);
-void UpdateHierarchicalMobility(Ptr<Node> superLeader, Ptr<Node> clusterLeaderA, Ptr<Node> clusterLeaderB, NodeContainer followersA, NodeContainer followersB, double followerSpeed, double noiseFactor);
+
+/**
+ * @brief Parameters of one simulated scenario (one point of a sweep).
+ */
+struct SimulationConfig {
+    uint32_t nodesPerCluster;
+    double simulationTime;
+    double areaSize;
+    double followerSpeed;
+    double noiseFactor;
+    uint32_t packetSizei;
+    double followerRate;    // Offered telemetry rate per follower (kbps)
+    std::string mobility;   // "tick" (periodic HierarchicalMobilityController) or "analytic" (lazy models)
+    std::string mobilityKernel; // Follower update kernel of the tick mode: auto, avx2, sse2 or scalar
+    std::vector<uint32_t> clusterFanout;    // Children per leader at each level below the super-leader
+    std::vector<double> formationRadius;    // Ring radius of each level around its parent (m), empty = default
+    std::string channel;                    // "yans" (YansWifiChannel) or "grid" (GridSpectrumChannel)
+    std::string channelPlan;                // "shared" (one channel) or "split" (one channel per subnet)
+    bool lossCache;                         // Wrap the propagation loss chain in CachedPropagationLossModel
+    std::string anim;                       // NetAnim output: "off", "positions" or "full"
+    double animInterval;                    // NetAnim position sampling interval (s)
+    uint64_t animMaxPackets;                // Packet transmissions recorded by NetAnim, 0 = unlimited
+    std::string resultsFile;                // Binary per-flow results of the whole sweep (MANET-Results.h)
+    double window;                          // Length of the streaming metrics windows (s), 0 = off
+    std::string windowsFile;                // Binary per-window metrics of the whole sweep
+    std::string nodesFile;                  // Binary per-node routing overhead of the whole sweep
+    bool profile;                           // Profile Simulator::Run per event type
+    std::string scheduler;                  // Event scheduler: "map", "heap", "list" or "calendar"
+    std::string routing;                    // "olsr", "aodv", "dsdv" (every node) or "static-hier" (OLSR on the backbone only)
+    double warmStart;                       // Fork point of the warm-start mode (s), 0 = off
+    double trafficStart;                    // Fixed telemetry start (s), < 0 = once routes have converged
+    double convergenceTimeout;              // Start the telemetry anyway at this time (s)
+    uint32_t uplinkBatch;                   // Records per leader-to-super-leader batch, 0 = no uplink
+    double uplinkDeadline;                  // Flush deadline of a partial uplink batch (s)
+    std::string manifestFile;               // JSON lines: seed, parameters and build id of every run
+};
+
+/**
+ * @brief One leader of a built hierarchy.
+ */
+struct HierarchyLeader {
+    Ptr<Node> node;
+    int32_t parent;         // Index of the parent leader, -1 for the super-leader
+    uint32_t level;         // Depth below the super-leader (0 = super-leader)
+    Vector offset;          // Formation offset from the parent
+    int32_t cluster;        // Index of the cluster this leaf leader heads, -1 otherwise
+};
+
+/**
+ * @brief One cluster: a leaf leader, its followers and their subnet.
+ */
+struct HierarchyCluster {
+    uint32_t leader;            // Index into Hierarchy::leaders
+    NodeContainer followers;
+    NodeContainer nodes;        // Followers then the leader, in subnet address order
+    Ipv4Address network;
+    Ipv4Mask mask;
+    Ipv4Address leaderAddress;  // Filled in when the subnet is addressed
+};
+
+/**
+ * @brief Tree of leaders and clusters that drives node creation, addressing,
+ * routing, applications and mobility.
+ *
+ * Leaders are stored breadth-first, so every parent precedes its children
+ * and index 0 is the super-leader.
+ */
+struct Hierarchy {
+    std::vector<HierarchyLeader> leaders;
+    std::vector<HierarchyCluster> clusters;
+    NodeContainer leaderNodes;      // All leaders in breadth-first order (the backbone)
+    NodeContainer followerNodes;    // All followers, cluster by cluster
+};
+
+/**
+ * @brief Per-run means of the per-flow metrics written to the statistics CSV.
+ */
+struct RunSummary {
+    bool valid;             // False until the run has completed
+    uint32_t flows;         // Telemetry flows included in the means
+    double pdr;             // Mean PacketDeliveryRatio (%)
+    double avgLatency;      // Mean AvgLatency_ms
+    double p95Latency;      // Mean P95Latency_ms of the flows that received packets, infinite if none did
+    double avgThroughput;   // Mean AvgThroughput_kbps
+    uint32_t nodes;         // Nodes in the scenario
+    double setupTime;       // Wall time of topology, stack and application setup (s)
+    double runTime;         // Wall time of Simulator::Run (s)
+    uint64_t events;        // Events executed by Simulator::Run
+    uint64_t peakRssKb;     // Peak resident set size of the run (kB)
+    double wallTime;        // Wall time of the whole run, setup to statistics export (s)
+    double convergenceTime; // Time all telemetry routes existed (s), -1 if they never did
+    uint64_t controlBytes;  // Routing control bytes sent, IP level
+    double controlDataRatio; // Control bytes / telemetry bytes sent
+};
+
+/**
+ * @brief One replication of one sweep point, as handed to the workers.
+ */
+struct SimulationTask {
+    SimulationConfig config;
+    uint32_t runNumber;     // 1-based, also used as the RngSeedManager run
+    uint32_t numRuns;       // Replications of this point, for progress output
+    double estimatedCost;   // Relative cost used to schedule the longest runs first
+    RunSummary summary;     // Filled in once the task has run
+};
+
+/**
+ * @brief Tasks continued from one warmed-up simulation (warm-start mode).
+ *
+ * The tasks share a run number and differ only in packet size and offered
+ * rate, so they share everything up to the warm-up time.
+ */
+struct WarmStartGroup {
+    const std::vector<SimulationTask>* tasks;   // All tasks of ExecuteTasks
+    std::vector<uint32_t> variants;             // Indices of the tasks of this group
+    RunSummary* summaries;                      // Shared with the children, one per task
+    uint32_t jobs;                              // Children running at once
+};
+
+/**
+ * @brief Service level and search range of the saturation-capacity search.
+ */
+struct CapacityTarget {
+    double pdr;             // Lowest acceptable mean PDR (%)
+    double p95Latency;      // Highest acceptable mean p95 latency (ms)
+    double minRate;         // Search range of the per-follower offered rate (kbps)
+    double maxRate;
+    double tolerance;       // Stop once the failing rate is within this fraction of the holding one
+    std::string fileName;   // Capacity curve CSV
+};
+
+/**
+ * @brief Cluster-leader mobility that holds a fixed offset from a reference node.
+ *
+ * Equivalent to the Level 1 update of HierarchicalMobilityController, but the
+ * position is derived from the reference on demand instead of being pushed
+ * every tick.
+ */
+class FormationMobilityModel : public MobilityModel {
+public:
+    static TypeId GetTypeId();
+    FormationMobilityModel();
+    void SetReference(Ptr<MobilityModel> reference, const Vector& offset);
+
+private:
+    Vector DoGetPosition() const override;
+    void DoSetPosition(const Vector& position) override;
+    Vector DoGetVelocity() const override;
+
+    Ptr<MobilityModel> m_reference;
+    Vector m_offset;
+};
+
+/**
+ * @brief Follower that pursues its leader, evaluated lazily when its position is read.
+ *
+ * Integrates the same dynamics as the Level 0 update of
+ * HierarchicalMobilityController (unit vector towards the leader times the
+ * speed, plus uniform noise, Euler step) on the same fixed step grid, but
+ * only when GetPosition() or GetVelocity() is called. Nothing is scheduled,
+ * so a follower that nobody observes costs nothing. The leader position at
+ * the skipped steps is interpolated linearly between the last and the
+ * current evaluation, which is exact while the leader moves in a straight
+ * line (as the waypoint super-leader does).
+ */
+class PursuitFollowerMobilityModel : public MobilityModel {
+public:
+    static TypeId GetTypeId();
+    PursuitFollowerMobilityModel();
+    void SetLeader(Ptr<MobilityModel> leader);
+
+private:
+    void Update() const;
+    Vector DoGetPosition() const override;
+    void DoSetPosition(const Vector& position) override;
+    Vector DoGetVelocity() const override;
+    int64_t DoAssignStreams(int64_t stream) override;
+
+    Ptr<MobilityModel> m_leader;
+    Ptr<UniformRandomVariable> m_noise;
+    double m_speed;                 // Pursuit speed in m/s
+    double m_noiseFactor;           // Noise amplitude per axis in m/s
+    Time m_step;                    // Integration step (the tick interval)
+    mutable Time m_lastUpdate;      // Step boundary the state below refers to
+    mutable Vector m_position;
+    mutable Vector m_velocity;
+    mutable Vector m_lastLeaderPos;
+};
+
+/**
+ * @brief Follower update kernel over structure-of-arrays state.
+ *
+ * Moves followers [0, n) one Euler step towards (leaderX, leaderY). On entry
+ * vx/vy hold the noise term of each follower; on exit they hold its velocity.
+ */
+typedef void (*FollowerStepKernel)(double* x, double* y, double* vx, double* vy, uint32_t n, double leaderX, double leaderY, double speed, double dt);
+
+/**
+ * @brief Static position that does not fire CourseChange when it is moved.
+ *
+ * Used for tick-driven followers when NetAnim only samples positions: the
+ * controller still moves them every tick, but NetAnim records them at its
+ * poll interval instead of on every teleport.
+ */
+class SilentPositionMobilityModel : public MobilityModel {
+public:
+    static TypeId GetTypeId();
+    SilentPositionMobilityModel();
+
+private:
+    Vector DoGetPosition() const override;
+    void DoSetPosition(const Vector& position) override;
+    Vector DoGetVelocity() const override;
+
+    Vector m_position;
+};
+
+/**
+ * @brief Stops NetAnim packet tracing after a number of transmissions.
+ */
+struct AnimPacketCap {
+    AnimationInterface* anim;
+    uint64_t remaining;
+};
+
+/**
+ * @brief Drives the periodic ("tick") hierarchical mobility update.
+ *
+ * Lives for the whole run: the mobility models are looked up once, the noise
+ * comes from a single RNG stream and the same event object is rescheduled
+ * every interval, so the tick code itself does not allocate; rescheduling
+ * may, depending on the event scheduler (see Tick()).
+ *
+ * Follower positions are kept in contiguous x/y/velocity arrays and advanced
+ * by a vectorized kernel, then written back to the mobility models in one
+ * pass. The controller owns the follower positions while it is running.
+ */
+class HierarchicalMobilityController {
+public:
+    HierarchicalMobilityController(const Hierarchy& hierarchy, double followerSpeed, double noiseFactor, Time interval, FollowerStepKernel kernel);
+    void Start();
+    void Stop();
+    uint64_t GetTicks() const;
+    uint64_t GetTickAllocations() const;
+
+private:
+    /**
+     * @brief Reusable event that calls Tick(); rescheduled instead of reallocated.
+     */
+    class TickEvent : public EventImpl {
+    public:
+        explicit TickEvent(HierarchicalMobilityController* controller);
+
+    private:
+        void Notify() override;
+        HierarchicalMobilityController* m_controller;
+    };
+
+    void Tick();
+
+    std::vector<Ptr<MobilityModel>> m_leaders;      // Breadth-first, index 0 is the super-leader
+    std::vector<int32_t> m_parents;                 // Parent index of each leader
+    std::vector<Vector> m_offsets;                  // Formation offset of each leader from its parent
+    std::vector<Vector> m_leaderPositions;          // Leader positions of the current tick
+    std::vector<Ptr<MobilityModel>> m_followers;    // Followers, cluster by cluster
+    std::vector<uint32_t> m_clusterBegin;           // Follower range [begin[c], begin[c + 1]) of cluster c
+    std::vector<uint32_t> m_clusterLeader;          // Leader index of cluster c
+    std::vector<double> m_x, m_y, m_z;              // Follower positions
+    std::vector<double> m_vx, m_vy;                 // Noise in, velocity out of the kernel
+    FollowerStepKernel m_kernel;
+    Ptr<UniformRandomVariable> m_noise;
+    Ptr<EventImpl> m_tickEvent;
+    double m_followerSpeed;
+    double m_noiseFactor;
+    Time m_interval;
+    bool m_running;
+    uint64_t m_ticks;
+    uint64_t m_tickAllocations;     // Heap allocations observed inside Tick(), MANET_COUNT_ALLOCATIONS builds only
+};
+
+/**
+ * @brief Spectrum channel that only delivers to receivers within radio range.
+ *
+ * Behaves like SingleModelSpectrumChannel, but keeps the attached PHYs in a
+ * uniform spatial grid whose cells are as large as the maximum range. A
+ * transmission only evaluates the loss of receivers in the 3x3 cells around
+ * the sender and drops those beyond the range, so per-packet work follows the
+ * local density instead of the total number of PHYs.
+ *
+ * The range is the distance at which the propagation loss chain brings
+ * MaxTxPowerDbm below RxThresholdDbm (found by bisection, which assumes the
+ * chain is deterministic and non-increasing with distance), unless MaxRange
+ * is set. Cells are updated on CourseChange; mobility models that move
+ * without notifying (the analytic ones) are covered by re-binning every
+ * RebinInterval and widening the cells by MaxNodeSpeed * RebinInterval.
+ * Signals beyond the range would only have added sub-threshold interference.
+ */
+class GridSpectrumChannel : public SpectrumChannel {
+public:
+    static TypeId GetTypeId();
+    GridSpectrumChannel();
+
+    void AddRx(Ptr<SpectrumPhy> phy) override;
+    void RemoveRx(Ptr<SpectrumPhy> phy) override;
+    void StartTx(Ptr<SpectrumSignalParameters> params) override;
+    std::size_t GetNDevices() const override;
+    Ptr<NetDevice> GetDevice(std::size_t i) const override;
+
+    double GetRange();
+    uint64_t GetTransmissions() const;
+    uint64_t GetEvaluatedReceivers() const;
+    uint64_t GetPrunedReceivers() const;
+
+protected:
+    void DoDispose() override;
+
+private:
+    /**
+     * @brief One attached PHY and the grid cell it was last binned into.
+     */
+    struct Receiver {
+        Ptr<SpectrumPhy> phy;
+        Ptr<MobilityModel> mobility;
+        int64_t cell;
+    };
+
+    static void StartRx(Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
+    void ComputeGeometry();
+    int64_t CellKey(int64_t ix, int64_t iy) const;
+    int64_t CellOf(const Vector& position) const;
+    void Bin(uint32_t index);
+    void RebinAll();
+    void CourseChanged(Ptr<const MobilityModel> mobility);
+
+    std::vector<Receiver> m_receivers;
+    std::unordered_map<int64_t, std::vector<uint32_t>> m_cells;             // Cell key -> receiver indices
+    std::unordered_map<const MobilityModel*, std::vector<uint32_t>> m_byMobility;
+    Ptr<const SpectrumModel> m_spectrumModel;
+    double m_maxTxPowerDbm;
+    double m_rxThresholdDbm;
+    double m_maxRange;          // Attribute; 0 = derive from the link budget
+    double m_range;             // Effective range, 0 until computed
+    double m_cellSize;
+    double m_maxNodeSpeed;
+    Time m_rebinInterval;
+    Time m_lastRebin;
+    uint64_t m_transmissions;
+    uint64_t m_evaluatedReceivers;
+    uint64_t m_prunedReceivers;
+};
+
+/**
+ * @brief Memoizes the gain of a propagation loss chain per (tx, rx) pair.
+ *
+ * Entries remember the endpoint positions they were computed for and are
+ * recomputed as soon as either endpoint has moved, i.e. on the next mobility
+ * tick or course change; frames sent in between reuse the cached gain. This
+ * is exact for deterministic chains whose loss does not depend on the
+ * transmit power (log-distance, Friis, ...), which is what RunSimulation
+ * builds. The table is cleared when it grows past MaxEntries.
+ */
+class CachedPropagationLossModel : public PropagationLossModel {
+public:
+    static TypeId GetTypeId();
+    CachedPropagationLossModel();
+
+    void SetInner(Ptr<PropagationLossModel> inner);
+    uint64_t GetHits() const;
+    uint64_t GetMisses() const;
+
+protected:
+    void DoDispose() override;
+
+private:
+    struct PairKey {
+        const MobilityModel* tx;
+        const MobilityModel* rx;
+        bool operator==(const PairKey& other) const { return tx == other.tx && rx == other.rx; }
+    };
+    struct PairKeyHash {
+        std::size_t operator()(const PairKey& key) const;
+    };
+    struct Entry {
+        Vector txPosition;
+        Vector rxPosition;
+        double gainDb;
+        bool valid = false;
+    };
+
+    double DoCalcRxPower(double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const override;
+    int64_t DoAssignStreams(int64_t stream) override;
+
+    Ptr<PropagationLossModel> m_inner;
+    mutable std::unordered_map<PairKey, Entry, PairKeyHash> m_cache;
+    uint32_t m_maxEntries;
+    mutable uint64_t m_hits;
+    mutable uint64_t m_misses;
+};
+
+/**
+ * @brief Fixed-size log-bucketed latency histogram (HDR-style).
+ *
+ * Latencies are recorded in microseconds. Values below 16 us get one bucket
+ * each; above that every power of two is split into 16 linear sub-buckets,
+ * so any recorded value is reported within 1/16 (6.25%) of itself, up to
+ * 2^32 us. The maximum is kept exactly. About 1.9 KB per flow.
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+    void Record(Time latency);
+    uint64_t GetCount() const;
+    double GetPercentileMs(double percentile) const;
+    double GetMaxMs() const;
+
+private:
+    static const uint32_t SubBuckets = 16;
+    static const uint32_t NumBuckets = SubBuckets + (32 - 4) * SubBuckets;
+
+    static uint32_t BucketOf(uint64_t micros);
+    static uint64_t BucketUpperBound(uint32_t bucket);
+
+    std::array<uint32_t, NumBuckets> m_counts;
+    uint64_t m_total;
+    uint64_t m_maxMicros;
+};
+
+/**
+ * @brief Detects when every route the telemetry needs exists.
+ *
+ * Every interval the routing protocol of each registered node is asked for
+ * a route to its destination through RouteOutput, as for a packet sent
+ * now; a loopback route (a reactive protocol still discovering, or DSDV
+ * without a route) does not count. The lookup carries an empty probe
+ * packet, since AODV and DSDV answer a null packet with a loopback route
+ * even when they have one. The scan resumes
+ * at the first missing route, and a full pass confirms the result before
+ * the routes count as converged. The time is then recorded and the
+ * callback runs; past the timeout the callback runs without convergence.
+ */
+class RouteConvergenceMonitor {
+public:
+    RouteConvergenceMonitor(Time interval, Time timeout);
+
+    void AddRoute(Ptr<Node> node, Ipv4Address destination);
+    void Start(Time first, std::function<void()> onDone);
+    double GetConvergenceTime() const;
+    uint32_t GetRoutes() const;
+    uint64_t GetChecks() const;
+
+private:
+    bool HasRoute(uint32_t index) const;
+    void Check();
+
+    std::vector<Ptr<Ipv4>> m_nodes;
+    std::vector<Ipv4Address> m_destinations;
+    std::function<void()> m_onDone;
+    Time m_interval;
+    Time m_timeout;
+    uint32_t m_next;            // First route not seen in the current scan
+    bool m_confirming;          // Doing the full confirmation pass
+    double m_convergenceTime;   // -1 until converged
+    uint64_t m_checks;          // Route lookups made
+};
+
+/**
+ * @brief Routing control traffic and routing-table recomputations, per node.
+ *
+ * Packets and bytes of every scheme come from the IPv4 Tx trace filtered on
+ * the protocol's UDP port, so they count once per interface transmission
+ * (a leader running OLSR on its backbone and cluster interfaces sends each
+ * control packet twice) and compare across schemes. Bytes are counted at
+ * the IP level, like the FlowMonitor bytes of the telemetry they are
+ * compared with. With OLSR the Tx and RoutingTableChanged traces add the
+ * per-message-type split and the recomputations: a message counts once per
+ * generated or forwarded OLSR packet, whatever the number of interfaces it
+ * leaves on, and message bytes are the OLSR message sizes.
+ */
+class ControlOverheadCounter {
+public:
+    struct Counters {
+        uint64_t helloMessages;
+        uint64_t helloBytes;
+        uint64_t tcMessages;
+        uint64_t tcBytes;
+        uint64_t hnaMessages;
+        uint64_t hnaBytes;
+        uint64_t packets;
+        uint64_t bytes;             // IP level
+        uint64_t recomputations;    // Routing-table computations
+    };
+
+    explicit ControlOverheadCounter(uint32_t nodes);
+
+    void NotifyTx(uint32_t node, const olsr::PacketHeader& header, const olsr::MessageList& messages);
+    void NotifyRoutingTableChanged(uint32_t node);
+    void NotifyControlPacket(uint32_t node, uint32_t bytes);
+    const Counters& GetNode(uint32_t node) const;
+    Counters GetTotal() const;
+
+private:
+    std::vector<Counters> m_nodes;
+};
+
+/**
+ * @brief Streams per-window PDR, latency and throughput of the telemetry flows.
+ *
+ * Fed by the OnOff TxWithSeqTsSize and PacketSink RxWithSeqTsSize traces.
+ * Only the counters of the current window are kept, one set per flow; when
+ * an event falls past the window end the window is emitted (flow rows plus
+ * one aggregate row per cluster) and the counters are reset. Rows go to the
+ * windows file in blocks of at most BlockRows rows, so memory does not grow
+ * with the simulation length. Every flow also keeps a LatencyHistogram over
+ * the whole run.
+ */
+class TelemetryCollector {
+public:
+    TelemetryCollector(const SimulationConfig& config, uint32_t runNumber, const std::string& windowsFileName);
+
+    uint32_t AddFlow(uint32_t cluster, Ipv4Address source);
+    void NotifyTx(uint32_t flow);
+    void NotifyRx(const Address& from, uint32_t bytes, Time delay);
+    void Reopen(uint32_t runNumber, const std::string& windowsFileName);
+    void Finish();
+    uint64_t GetWindows() const;
+    const LatencyHistogram* FindLatencyHistogram(Ipv4Address source) const;
+
+private:
+    /**
+     * @brief Counters of one flow (or cluster) over the current window.
+     */
+    struct WindowCounters {
+        uint32_t txPackets;
+        uint32_t rxPackets;
+        uint64_t rxBytes;
+        double delaySum;    // ms
+    };
+
+    static const uint32_t BlockRows = 4096;
+
+    void Advance(Time now);
+    void EmitWindow(Time length);
+    void AddRow(uint32_t cluster, Ipv4Address source, const WindowCounters& counters, double length);
+
+    const SimulationConfig& m_config;
+    uint32_t m_runNumber;
+    Time m_window;
+    Time m_windowStart;
+    std::vector<uint32_t> m_flowCluster;
+    std::vector<Ipv4Address> m_flowSource;
+    std::vector<WindowCounters> m_flows;
+    std::vector<WindowCounters> m_clusters;
+    std::vector<LatencyHistogram> m_latency;                 // Per flow, whole run
+    std::unordered_map<uint32_t, uint32_t> m_flowBySource;  // Source IPv4 -> flow index
+    ResultsBlock m_rows;
+    ResultsAppender m_file;
+    uint64_t m_windows;
+};
+
+/**
+ * @brief Event count and wall time per event implementation type.
+ *
+ * Filled by ProfilingScheduler: the time from handing one event to the
+ * simulator until the next event is requested is charged to the first
+ * one, which covers its Invoke() plus the scheduling it does. Types are
+ * keyed by their std::type_info, so the per-event cost is one clock read
+ * and one hash lookup.
+ */
+class EventProfile {
+public:
+    EventProfile();
+    void BeginEvent(const std::type_info& type);
+    void EndEvent();
+    void Report(std::ostream& table, const std::string& fileName) const;
+
+private:
+    struct TypeStats {
+        const std::type_info* type;
+        uint64_t count;
+        uint64_t nanos;
+    };
+
+    static std::string Demangle(const std::type_info& type);
+    static std::string Category(const std::string& name);
+
+    std::unordered_map<const std::type_info*, uint32_t> m_index;
+    std::vector<TypeStats> m_stats;
+    int32_t m_current;      // Index of the event being timed, -1 if none
+    std::chrono::steady_clock::time_point m_start;
+};
+
+/**
+ * @brief Scheduler that forwards to another one and feeds the active EventProfile.
+ *
+ * Installed with Simulator::SetScheduler() only when --profile is given.
+ */
+class ProfilingScheduler : public Scheduler {
+public:
+    static TypeId GetTypeId();
+    ProfilingScheduler();
+
+    void Insert(const Event& ev) override;
+    bool IsEmpty() const override;
+    Event PeekNext() const override;
+    Event RemoveNext() override;
+    void Remove(const Event& ev) override;
+
+private:
+    void SetInnerScheduler(std::string typeName);
+
+    Ptr<Scheduler> m_inner;
+};
+
+/**
+ * @brief Header of an aggregated telemetry packet: send time and size of each record it carries.
+ *
+ * Serialized as a 16-bit record count followed by 12 bytes per record
+ * (send time in ns, telemetry bytes).
+ */
+class TelemetryBatchHeader : public Header {
+public:
+    struct Record {
+        Time sent;
+        uint32_t bytes;
+    };
+
+    static TypeId GetTypeId();
+    TypeId GetInstanceTypeId() const override;
+    uint32_t GetSerializedSize() const override;
+    void Serialize(Buffer::Iterator start) const override;
+    uint32_t Deserialize(Buffer::Iterator start) override;
+    void Print(std::ostream& os) const override;
+
+    void AddRecord(Time sent, uint32_t bytes);
+    void Clear();
+    const std::vector<Record>& GetRecords() const;
+
+private:
+    std::vector<Record> m_records;
+};
+
+/**
+ * @brief Cluster-leader application that forwards received telemetry to the super-leader in batches.
+ *
+ * Fed by the RxWithSeqTsSize trace of the leader's sink. A batch goes out
+ * as one UDP packet once it holds BatchSize records, or FlushDeadline after
+ * its first record, whichever comes first. Its payload is as long as the
+ * telemetry it carries plus one TelemetryBatchHeader, so batching saves the
+ * per-packet headers and medium accesses at the cost of the waiting time.
+ */
+class TelemetryAggregator : public Application {
+public:
+    static TypeId GetTypeId();
+    TelemetryAggregator();
+
+    void Enqueue(Time sent, uint32_t bytes);
+    uint64_t GetRecordsSent() const;
+    uint64_t GetBatchesSent() const;
+
+protected:
+    void DoDispose() override;
+
+private:
+    static const uint32_t MaxPayload = 65507; // Largest UDP payload over IPv4
+
+    void StartApplication() override;
+    void StopApplication() override;
+    void Flush();
+
+    Address m_remote;
+    uint32_t m_batchSize;       // Records per batch
+    Time m_flushDeadline;       // Longest wait of the first record of a batch
+    Ptr<Socket> m_socket;
+    TelemetryBatchHeader m_batch;
+    uint32_t m_batchBytes;      // Telemetry bytes in m_batch
+    EventId m_flushEvent;
+    uint64_t m_recordsSent;
+    uint64_t m_batchesSent;
+};
+
+/**
+ * @brief What the super-leader receives over the aggregation uplink.
+ */
+struct UplinkStats {
+    uint64_t batches;
+    uint64_t records;
+    uint64_t bytes;             // Batch packets, UDP payload level
+    uint64_t recordBytes;       // Telemetry carried (goodput)
+    Time delaySum;              // Follower send to super-leader receive, all records
+    Time firstRx;
+    Time lastRx;
+    LatencyHistogram latency;
+};
+
+void OlsrTxTrace(ControlOverheadCounter* counter, uint32_t node, const olsr::PacketHeader& header, const olsr::MessageList& messages);
+void OlsrRoutingTableTrace(ControlOverheadCounter* counter, uint32_t node, uint32_t size);
+void RoutingControlTxTrace(ControlOverheadCounter* counter, uint16_t port, uint32_t node, Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
+void TelemetryTxTrace(TelemetryCollector* collector, uint32_t flow, Ptr<const Packet> packet, const Address& from, const Address& to, const SeqTsSizeHeader& header);
+void TelemetryRxTrace(TelemetryCollector* collector, Ptr<const Packet> packet, const Address& from, const Address& to, const SeqTsSizeHeader& header);
+void AggregatorRxTrace(TelemetryAggregator* aggregator, Ptr<const Packet> packet, const Address& from, const Address& to, const SeqTsSizeHeader& header);
+void UplinkRxTrace(UplinkStats* stats, Ptr<const Packet> packet, const Address& from);
+RunSummary RunSimulation(const SimulationConfig& scenario, uint32_t runNumber, std::string fileSuffix, const WarmStartGroup* warmStart = nullptr);
+Hierarchy BuildHierarchy(const SimulationConfig& config);
+uint32_t CountClusters(const SimulationConfig& config);
+uint32_t CountLeaders(const SimulationConfig& config);
+Ptr<olsr::RoutingProtocol> FindOlsr(Ptr<Node> node);
+void ExecuteTasks(std::vector<SimulationTask>& tasks, uint32_t jobs);
+void ExecuteWarmStarted(std::vector<SimulationTask>& tasks, uint32_t jobs);
+void ExecuteTasksIsolated(std::vector<SimulationTask>& tasks, uint32_t jobs);
+RunSummary RunTask(const SimulationTask& task, const std::string& fileSuffix);
+void RunUntilConverged(const std::vector<SimulationConfig>& points, uint32_t jobs, double ciTarget, uint32_t minRuns, uint32_t maxRuns);
+double ConfidenceHalfWidth(const std::vector<double>& samples, double* mean);
+double EstimateTaskCost(const SimulationConfig& config);
+std::vector<SimulationConfig> ExpandSweepGrid(const SimulationConfig& base, const std::vector<uint32_t>& nodesPerClusterValues, const std::vector<double>& followerSpeedValues, const std::vector<double>& noiseFactorValues, const std::vector<uint32_t>& packetSizeValues, const std::vector<double>& followerRateValues);
+std::vector<double> ParseSweepValues(const std::string& spec, const std::string& name);
+std::vector<uint32_t> ParseSweepIntegers(const std::string& spec, const std::string& name);
+std::string RunFileStem(const SimulationConfig& config, uint32_t runNumber);
+std::string FanoutLabel(const std::vector<uint32_t>& clusterFanout);
+std::string SchedulerTypeName(const std::string& scheduler);
+void RunSchedulerBenchmark(const std::vector<SimulationConfig>& points, uint32_t jobs);
+void RunRoutingBenchmark(const std::vector<SimulationConfig>& points, uint32_t numRuns, uint32_t jobs);
+void RunScalingBenchmark(const SimulationConfig& base, const std::vector<uint32_t>& nodesPerClusterValues, const std::vector<uint32_t>& clusterValues, const std::vector<double>& simTimeValues, uint32_t jobs, const std::string& fileName);
+void RunCapacitySearch(const std::vector<SimulationConfig>& points, uint32_t numRuns, uint32_t jobs, const CapacityTarget& target);
+double SecondsSince(std::chrono::steady_clock::time_point* mark);
+void ResetPeakRss();
+uint64_t PeakRssKb();
+std::string BinaryBuildId();
+std::string ConfigJson(const SimulationConfig& config);
+uint64_t NewRunId();
+void WriteRunManifest(const SimulationConfig& config, uint32_t runNumber, uint64_t runId, const std::string& fileName);
+std::string AnimFileName(const SimulationConfig& config, uint32_t runNumber);
+void AnimPacketCapTrace(AnimPacketCap* cap, Ptr<const Packet> packet, double txPowerW);
+std::string TaskPartSuffix(uint32_t taskIndex);
+void MergeTaskPartFiles(const std::vector<SimulationTask>& tasks);
+void MergeResultsPartFile(const std::string& resultsFileName, const std::string& partFileName);
+void MergeTextPartFile(const std::string& fileName, const std::string& partFileName);
 ns3::Vector Normalize(const ns3::Vector& v); // Function prototype for Normalize
+void FollowerStepScalar(double* x, double* y, double* vx, double* vy, uint32_t n, double leaderX, double leaderY, double speed, double dt);
+FollowerStepKernel SelectFollowerStepKernel(const std::string& name);
 
 //================================================================================
 // 4. MAIN FUNCTION
 //================================================================================
 int main(int argc, char *argv[]) {
     // --- Simulation Parameters ---
-    uint32_t nodesPerCluster = 5;
-    double simulationTime = 160.0; // seconds
-    double areaSize = 200.0;       // 200x200 meters
-    double followerSpeed = 1.5;    // m/s
-    double noiseFactor = 1.0;      // randomness in follower movement
-    uint32_t packetSizei = 1024;   // Packetsize variety
-    uint32_t numRuns = 1;          // New parameter for number of runs
+    // The swept parameters accept a single value, a list (a,b,c) or a range (start:stop[:step]).
+    std::string nodesPerCluster = "5";
+    double simulationTime = 160.0;      // seconds
+    double areaSize = 200.0;            // 200x200 meters
+    std::string followerSpeed = "1.5";  // m/s
+    std::string noiseFactor = "1.0";    // randomness in follower movement
+    std::string packetSizei = "1024";   // Packetsize variety
+    std::string followerRate = "256";   // Offered telemetry rate per follower (kbps)
+    uint32_t numRuns = 1;               // New parameter for number of runs
+    uint32_t jobs = 1;                  // Worker processes for the replications (1 = sequential)
+    double ciTarget = 0.0;              // Relative 95% CI half-width to stop at (0 = fixed numRuns)
+    uint32_t minRuns = 3;               // Replications before the stopping rule is checked
+    uint32_t maxRuns = 30;              // Cap on replications per point with the stopping rule
+    std::string mobility = "tick";      // Follower mobility implementation
+    std::string mobilityKernel = "auto"; // SIMD kernel for the tick-mode follower update
+    std::string clusterFanout = "2";    // Clusters per leader, one entry per hierarchy level
+    std::string formationRadius = "";   // Formation ring radius per level (m), empty = default
+    std::string channel = "yans";       // Wireless channel implementation
+    std::string channelPlan = "shared"; // Channel allocation across subnets
+    bool lossCache = false;             // Cache propagation loss per node pair between moves
+    std::string anim = "off";           // NetAnim output
+    double animInterval = 1.0;          // NetAnim position sampling interval (s)
+    uint64_t animMaxPackets = 100000;   // Packet transmissions recorded by NetAnim (0 = unlimited)
+    std::string resultsFile = "hierarchical_manet_results.bin"; // Per-flow results, export with MANET-Results-Export
+    double window = 1.0;                // Streaming metrics window (s), 0 = off
+    std::string windowsFile = "hierarchical_manet_windows.bin"; // Per-window metrics
+    std::string nodesFile = "hierarchical_manet_nodes.bin"; // Per-node routing overhead
+    bool profile = false;               // Per-event-type profiling of Simulator::Run
+    std::string manifestFile = "hierarchical_manet_manifest.jsonl"; // Seed, parameters and build id per run
+    std::string scheduler = "map";      // ns-3 event scheduler
+    std::string routing = "olsr";       // Routing scheme
+    double warmStart = 0.0;             // Warm-start fork point (s), 0 = off
+    std::string trafficStart = "auto";  // Telemetry start: auto (routes converged) or a time (s)
+    double convergenceTimeout = 10.0;   // Latest telemetry start in auto mode (s)
+    uint32_t uplinkBatch = 0;           // Telemetry records per uplink batch (0 = no uplink)
+    double uplinkDeadline = 0.1;        // Uplink flush deadline (s)
+    std::string benchmark = "";         // Benchmark mode instead of a plain sweep
+    std::string benchNodes = "5,10,20,50,100,200,500,1000"; // Scaling benchmark: nodesPerCluster values
+    std::string benchClusters = "2,4,8"; // Scaling benchmark: cluster counts (one hierarchy level)
+    std::string benchSimTime = "10,30"; // Scaling benchmark: simTime values (s)
+    std::string benchmarkFile = "hierarchical_manet_scaling_benchmark.json"; // Scaling benchmark output
+    bool capacity = false;              // Saturation-capacity search instead of a plain sweep
+    double capacityPdr = 95.0;          // Capacity search: lowest acceptable mean PDR (%)
+    double capacityLatency = 100.0;     // Capacity search: highest acceptable mean p95 latency (ms)
+    double capacityMinRate = 8.0;       // Capacity search: lowest offered rate tried (kbps)
+    double capacityMaxRate = 2048.0;    // Capacity search: highest offered rate tried (kbps)
+    double capacityTolerance = 0.05;    // Capacity search: relative width the rate is bracketed to
+    std::string capacityFile = "hierarchical_manet_capacity.csv"; // Capacity curve
     // --- Command Line Parser for customization ---
     CommandLine cmd;
-    cmd.AddValue("nodesPerCluster", "Number of follower nodes per cluster", nodesPerCluster);
+    cmd.AddValue("nodesPerCluster", "Number of follower nodes per cluster (value, list or range)", nodesPerCluster);
     cmd.AddValue("simTime", "Total simulation time in seconds", simulationTime);
     cmd.AddValue("areaSize", "Side length of the simulation area in meters", areaSize);
-    cmd.AddValue("followerSpeed", "Speed of follower nodes in m/s", followerSpeed);
-    cmd.AddValue("noiseFactor", "Noise factor for follower movement", noiseFactor);
-    cmd.AddValue("packetSizei", "Packet size for the nodes", packetSizei);
+    cmd.AddValue("followerSpeed", "Speed of follower nodes in m/s (value, list or range)", followerSpeed);
+    cmd.AddValue("noiseFactor", "Noise factor for follower movement (value, list or range)", noiseFactor);
+    cmd.AddValue("packetSizei", "Packet size for the nodes (value, list or range)", packetSizei);
+    cmd.AddValue("followerRate", "Offered telemetry rate per follower in kbps (value, list or range)", followerRate);
     cmd.AddValue("numRuns", "Number of simulation repetitions", numRuns); // Added numRuns
+    cmd.AddValue("jobs", "Number of worker processes running replications in parallel", jobs);
+    cmd.AddValue("ciTarget", "Replicate until the relative 95% CI half-width of PDR, latency and throughput is below this (0 = use numRuns)", ciTarget);
+    cmd.AddValue("minRuns", "Minimum replications per point when ciTarget is set", minRuns);
+    cmd.AddValue("maxRuns", "Maximum replications per point when ciTarget is set", maxRuns);
+    cmd.AddValue("mobility", "Hierarchical mobility: tick (0.1 s update event) or analytic (evaluated on demand)", mobility);
+    cmd.AddValue("mobilityKernel", "Follower update kernel for tick mobility: auto, avx2, sse2 or scalar", mobilityKernel);
+    cmd.AddValue("clusterFanout", "Children per leader at each level below the super-leader, e.g. 2 or 10,4", clusterFanout);
+    cmd.AddValue("formationRadius", "Formation ring radius in m for each level, e.g. 70.7,20 (default halves per level)", formationRadius);
+    cmd.AddValue("channel", "Wireless channel: yans (every PHY receives every frame) or grid (spatial-grid receiver pruning)", channel);
+    cmd.AddValue("channelPlan", "Channel plan: shared (all subnets on one channel) or split (backbone and each cluster on its own channel)", channelPlan);
+    cmd.AddValue("lossCache", "Cache the propagation loss per (tx, rx) pair until either node moves", lossCache);
+    cmd.AddValue("anim", "NetAnim output: off, positions (sampled node positions) or full (positions + packets)", anim);
+    cmd.AddValue("animInterval", "NetAnim position sampling interval in s", animInterval);
+    cmd.AddValue("animMaxPackets", "Packet transmissions recorded by NetAnim in full mode (0 = unlimited)", animMaxPackets);
+    cmd.AddValue("resultsFile", "Binary results file the per-flow statistics of every run are appended to", resultsFile);
+    cmd.AddValue("window", "Window in s for the streaming per-flow/per-cluster metrics (0 = off)", window);
+    cmd.AddValue("windowsFile", "Binary file the per-window metrics of every run are appended to", windowsFile);
+    cmd.AddValue("nodesFile", "Binary file the per-node routing control overhead of every run is appended to", nodesFile);
+    cmd.AddValue("profile", "Count events and wall time per event type in Simulator::Run (ranked table + CSV per run)", profile);
+    cmd.AddValue("manifestFile", "JSON-lines file the seed, parameters and build id of every run are appended to", manifestFile);
+    cmd.AddValue("scheduler", "Event scheduler: map, heap, list or calendar", scheduler);
+    cmd.AddValue("routing", "Routing: olsr, aodv or dsdv on every node, or static-hier (followers use a static default route to their leader, OLSR + HNA only on the leader backbone)", routing);
+    cmd.AddValue("trafficStart", "Telemetry start: auto (as soon as OLSR routes to the leaders exist) or a time in s", trafficStart);
+    cmd.AddValue("convergenceTimeout", "Start the telemetry at this time in s even if the routes have not converged", convergenceTimeout);
+    cmd.AddValue("uplinkBatch", "Cluster leaders forward the telemetry to the super-leader in batches of this many records (0 = no uplink)", uplinkBatch);
+    cmd.AddValue("uplinkDeadline", "Send a partial uplink batch this many s after its first record", uplinkDeadline);
+    cmd.AddValue("warmStart", "Run to this time once per scenario and run, then fork a child per packet size and rate (0 = off)", warmStart);
+    cmd.AddValue("benchmark", "Benchmark mode: scheduler (every sweep point once per scheduler, e.g. with --nodesPerCluster=5,20,50) scaling (benchNodes x benchClusters x benchSimTime) or routing (every point and run once per routing scheme)", benchmark);
+    cmd.AddValue("benchNodes", "Scaling benchmark: nodesPerCluster values (list or range)", benchNodes);
+    cmd.AddValue("benchClusters", "Scaling benchmark: number of clusters under the super-leader (list or range)", benchClusters);
+    cmd.AddValue("benchSimTime", "Scaling benchmark: simTime values in s (list or range)", benchSimTime);
+    cmd.AddValue("benchmarkFile", "JSON file the scaling benchmark is written to", benchmarkFile);
+    cmd.AddValue("capacity", "Search the highest per-follower rate at which capacityPdr and capacityLatency hold, per nodesPerCluster x packetSizei point (numRuns replications per probe)", capacity);
+    cmd.AddValue("capacityPdr", "Capacity search: lowest acceptable mean PDR in %", capacityPdr);
+    cmd.AddValue("capacityLatency", "Capacity search: highest acceptable mean p95 latency in ms", capacityLatency);
+    cmd.AddValue("capacityMinRate", "Capacity search: lowest per-follower rate in kbps", capacityMinRate);
+    cmd.AddValue("capacityMaxRate", "Capacity search: highest per-follower rate in kbps", capacityMaxRate);
+    cmd.AddValue("capacityTolerance", "Capacity search: stop once the failing rate is within this fraction above the holding one", capacityTolerance);
+    cmd.AddValue("capacityFile", "CSV file the capacity curve is appended to", capacityFile);
     cmd.Parse(argc, argv);
 
-    // --- Run Simulation Loop ---
-    for (uint32_t run = 0; run < numRuns; ++run) {
-        RngSeedManager::SetRun(run + 1); // Set a unique random seed for each run 
-        std::cout << "Running simulation " << (run + 1) << "/" << numRuns << " for packet size: " << packetSizei << std::endl;
-        // Pass all parameters, including the current run number
-        RunSimulation(nodesPerCluster, simulationTime, areaSize, followerSpeed, noiseFactor, packetSizei, run + 1);
+    NS_ABORT_MSG_IF(mobility != "tick" && mobility != "analytic", "Unknown --mobility=" << mobility);
+    SelectFollowerStepKernel(mobilityKernel); // Validates the name before any run starts
+    NS_ABORT_MSG_IF(channel != "yans" && channel != "grid", "Unknown --channel=" << channel);
+    NS_ABORT_MSG_IF(channelPlan != "shared" && channelPlan != "split", "Unknown --channelPlan=" << channelPlan);
+    NS_ABORT_MSG_IF(anim != "off" && anim != "positions" && anim != "full", "Unknown --anim=" << anim);
+    NS_ABORT_MSG_IF(animInterval <= 0, "--animInterval must be positive");
+    NS_ABORT_MSG_IF(window < 0, "--window must not be negative");
+    SchedulerTypeName(scheduler); // Validates the name before any run starts
+    NS_ABORT_MSG_IF(routing != "olsr" && routing != "aodv" && routing != "dsdv" && routing != "static-hier", "Unknown --routing=" << routing);
+    double fixedTrafficStart = -1.0;
+    if (trafficStart != "auto") {
+        char* end = nullptr;
+        fixedTrafficStart = std::strtod(trafficStart.c_str(), &end);
+        NS_ABORT_MSG_IF(trafficStart.empty() || *end != '\0' || fixedTrafficStart < 0, "Invalid --trafficStart=" << trafficStart);
+    }
+    NS_ABORT_MSG_IF(convergenceTimeout <= 0, "--convergenceTimeout must be positive");
+    NS_ABORT_MSG_IF(uplinkBatch > 4096, "--uplinkBatch must be at most 4096 records");
+    NS_ABORT_MSG_IF(uplinkBatch > 0 && uplinkDeadline <= 0, "--uplinkDeadline must be positive");
+    NS_ABORT_MSG_IF(warmStart < 0 || warmStart >= simulationTime, "--warmStart must be in [0, simTime)");
+    NS_ABORT_MSG_IF(fixedTrafficStart >= 0 && warmStart >= fixedTrafficStart, "--warmStart must come before --trafficStart");
+    NS_ABORT_MSG_IF(warmStart > 0 && anim != "off", "--warmStart cannot be combined with --anim");
+    NS_ABORT_MSG_IF(capacity && (capacityMinRate <= 0 || capacityMaxRate <= capacityMinRate), "--capacityMinRate must be positive and below --capacityMaxRate");
+    NS_ABORT_MSG_IF(capacity && capacityTolerance <= 0, "--capacityTolerance must be positive");
+    NS_ABORT_MSG_IF(capacity && numRuns == 0, "--capacity needs at least one run per probe");
+    NS_ABORT_MSG_IF(!benchmark.empty() && benchmark != "scheduler" && benchmark != "scaling" && benchmark != "routing", "Unknown --benchmark=" << benchmark);
+
+    // --- Sweep Grid Expansion ---
+    SimulationConfig base = SimulationConfig();
+    base.simulationTime = simulationTime;
+    base.areaSize = areaSize;
+    base.mobility = mobility;
+    base.mobilityKernel = mobilityKernel;
+    base.channel = channel;
+    base.channelPlan = channelPlan;
+    base.lossCache = lossCache;
+    base.anim = anim;
+    base.animInterval = animInterval;
+    base.animMaxPackets = animMaxPackets;
+    base.resultsFile = resultsFile;
+    base.window = window;
+    base.windowsFile = windowsFile;
+    base.nodesFile = nodesFile;
+    base.profile = profile;
+    base.manifestFile = manifestFile;
+    base.scheduler = scheduler;
+    base.routing = routing;
+    base.warmStart = warmStart;
+    base.trafficStart = fixedTrafficStart;
+    base.convergenceTimeout = convergenceTimeout;
+    base.uplinkBatch = uplinkBatch;
+    base.uplinkDeadline = uplinkDeadline;
+    base.clusterFanout = ParseSweepIntegers(clusterFanout, "clusterFanout");
+    if (!formationRadius.empty()) {
+        base.formationRadius = ParseSweepValues(formationRadius, "formationRadius");
     }
+    for (uint32_t fanout : base.clusterFanout) {
+        NS_ABORT_MSG_IF(fanout == 0, "--clusterFanout entries must be at least 1");
+    }
+    NS_ABORT_MSG_IF(FanoutLabel(base.clusterFanout).size() > RESULTS_LABEL_WIDTH,
+                    "--clusterFanout does not fit the ClusterFanout results column (" << RESULTS_LABEL_WIDTH << " characters)");
+    std::vector<SimulationConfig> points = ExpandSweepGrid(base,
+                                                           ParseSweepIntegers(nodesPerCluster, "nodesPerCluster"),
+                                                           ParseSweepValues(followerSpeed, "followerSpeed"),
+                                                           ParseSweepValues(noiseFactor, "noiseFactor"),
+                                                           ParseSweepIntegers(packetSizei, "packetSizei"),
+                                                           ParseSweepValues(followerRate, "followerRate"));
+
+    // --- Benchmarks ---
+    if (benchmark == "scheduler") {
+        RunSchedulerBenchmark(points, jobs);
+        return 0;
+    }
+    if (benchmark == "routing") {
+        RunRoutingBenchmark(points, numRuns, jobs);
+        return 0;
+    }
+    if (benchmark == "scaling") {
+        // The first sweep point supplies every parameter the grid does not vary
+        RunScalingBenchmark(points.front(),
+                            ParseSweepIntegers(benchNodes, "benchNodes"),
+                            ParseSweepIntegers(benchClusters, "benchClusters"),
+                            ParseSweepValues(benchSimTime, "benchSimTime"),
+                            jobs, benchmarkFile);
+        return 0;
+    }
+
+    // --- Saturation Capacity Search ---
+    if (capacity) {
+        CapacityTarget target = {capacityPdr, capacityLatency, capacityMinRate, capacityMaxRate, capacityTolerance, capacityFile};
+        RunCapacitySearch(points, numRuns, jobs, target);
+        return 0;
+    }
+
+    // --- Sequential Stopping Rule ---
+    if (ciTarget > 0) {
+        RunUntilConverged(points, jobs, ciTarget, minRuns, maxRuns);
+        return 0;
+    }
+
+    std::vector<SimulationTask> tasks;
+    for (const SimulationConfig& point : points) {
+        for (uint32_t run = 0; run < numRuns; ++run) {
+            tasks.push_back({point, run + 1, numRuns, EstimateTaskCost(point), RunSummary()});
+        }
+    }
+    if (points.size() > 1) {
+        std::cout << "Sweep of " << points.size() << " points x " << numRuns << " runs" << std::endl;
+    }
+
+    // --- Run Simulation Loop ---
+    // The Simulator is a process-wide singleton, so parallel runs happen in worker processes.
+    ExecuteTasks(tasks, jobs);
 
     return 0;
 }
@@ -87,31 +1081,52 @@ int main(int argc, char *argv[]) {
 
 /**
  * @brief Configures and runs the hierarchical MANET simulation.
+ *
+ * @param fileSuffix Appended to the results and windows file names; workers
+ *        use it to write private part files.
+ * @param warmStart Warm-start mode: the scenario runs to config.warmStart
+ *        and every task of the group is continued in a forked child, which
+ *        switches to its own packet size, rate and run before the telemetry
+ *        starts. The parent returns an invalid summary; the children report
+ *        through WarmStartGroup::summaries.
  */
-void RunSimulation(uint32_t nodesPerCluster, double simulationTime, double areaSize, double followerSpeed, double noiseFactor, uint32_t packetSizei, uint32_t runNumber) {
+RunSummary RunSimulation(const SimulationConfig& scenario, uint32_t runNumber, std::string fileSuffix, const WarmStartGroup* warmStart) {
+    SimulationConfig config = scenario; // Replaced by the variant in a warm-start child
+    const uint32_t nodesPerCluster = config.nodesPerCluster;
+    const double simulationTime = config.simulationTime;
+    const double areaSize = config.areaSize;
+    const double followerSpeed = config.followerSpeed;
+    const double noiseFactor = config.noiseFactor;
+    uint32_t packetSizei = config.packetSizei;
+
+    // --- Phase Timing ---
+    // Wall time per phase, written to every results row of the run: topology
+    // (nodes, mobility, Wi-Fi devices and channels), stack (IP, routing,
+    // addressing), apps, run and export
+    ResetPeakRss();
+    std::chrono::steady_clock::time_point phaseMark = std::chrono::steady_clock::now();
+    double topologyTime = 0.0;
+    double stackTime = 0.0;
+    double appsTime = 0.0;
+    double runTime = 0.0;
+    double exportTime = 0.0;
+
+    // --- Event Scheduler ---
+    // Set on every run: Simulator::Destroy() falls back to the default scheduler.
+    EventProfile eventProfile;
+    ObjectFactory scheduler(SchedulerTypeName(config.scheduler));
+    if (config.profile) {
+        scheduler.SetTypeId("ProfilingScheduler");
+        scheduler.Set("InnerScheduler", StringValue(SchedulerTypeName(config.scheduler)));
+    }
+    Simulator::SetScheduler(scheduler);
+
     // --- Node Creation ---
-    // Level 2
-    NodeContainer superLeaderContainer;
-    superLeaderContainer.Create(1);
-    Ptr<Node> superLeader = superLeaderContainer.Get(0);
-
-    // Level 1
-    NodeContainer clusterLeadersContainer;
-    clusterLeadersContainer.Create(2);
-    Ptr<Node> clusterLeaderA = clusterLeadersContainer.Get(0);
-    Ptr<Node> clusterLeaderB = clusterLeadersContainer.Get(1);
-
-    // Level 0
-    NodeContainer followersA, followersB;
-    followersA.Create(nodesPerCluster - 1); // -1 because the leader is also part of the cluster
-    followersB.Create(nodesPerCluster - 1);
-
-    // Full cluster containers for convenience
-    NodeContainer clusterA_nodes = followersA;
-    clusterA_nodes.Add(clusterLeaderA);
-    NodeContainer clusterB_nodes = followersB;
-    clusterB_nodes.Add(clusterLeaderB);
-    
+    // Super-leader, then every leader level, then the followers of each cluster
+    Hierarchy hierarchy = BuildHierarchy(config);
+    Ptr<Node> superLeader = hierarchy.leaders[0].node;
+    std::cout << "Hierarchy: " << hierarchy.leaders.size() << " leaders, " << hierarchy.clusters.size()
+              << " clusters, " << hierarchy.followerNodes.GetN() << " followers" << std::endl;
 
     Ptr<RandomRectanglePositionAllocator> alloc = CreateObject<RandomRectanglePositionAllocator>();
 
@@ -145,29 +1160,63 @@ void RunSimulation(uint32_t nodesPerCluster, double simulationTime, double areaS
 
     // Añadir waypoint
     mobilitySuperLeader->AddWaypoint(Waypoint(Seconds(moveTime), newPosition));
-    
 
-    // lideres mobilidad
-    
-    Ptr<PositionAllocator> positionAlloc = CreateObject<RandomRectanglePositionAllocator>();
-    positionAlloc->SetAttribute("X", StringValue("ns3::UniformRandomVariable[Min=0.0|Max=200.0]"));
-    positionAlloc->SetAttribute("Y", StringValue("ns3::UniformRandomVariable[Min=0.0|Max=200.0]"));
-
-    MobilityHelper mobilityLeaders;
-    mobilityLeaders.SetMobilityModel("ns3::RandomWaypointMobilityModel",
-        "Speed", StringValue("ns3::UniformRandomVariable[Min=0.5|Max=1.5]"), // movimiento lento
-        "Pause", StringValue("ns3::ConstantRandomVariable[Constant=5.0]"),  // pausas realistas
-        "PositionAllocator", PointerValue(positionAlloc));
+    // Upper bound on every node's speed, for the grid channel's cell widening:
+    // the fastest leader (the super-leader's waypoint leg, copied by the
+    // formation, or the 1.5 m/s RandomWaypoint leaders) plus the follower
+    // pursuit speed and its noise (up to noiseFactor per axis).
+    double leaderMaxSpeed = std::max(1.5, CalculateDistance(Vector(50.0, 50.0, 0.0), newPosition) / moveTime);
+    const double maxNodeSpeed = leaderMaxSpeed + followerSpeed + noiseFactor * std::sqrt(2.0);
     
 
-    mobilityLeaders.SetPositionAllocator(positionAlloc);
-    mobilityLeaders.Install(clusterLeadersContainer);
-    
-    MobilityHelper mobility;
-    // seguidores mobilidad
-    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
-    mobility.Install(followersA);
-    mobility.Install(followersB);
+    bool analyticMobility = (config.mobility == "analytic");
+
+    if (analyticMobility) {
+        // Leaders and followers derive their positions on demand; no update event is needed.
+        std::vector<Ptr<MobilityModel>> leaderModels(hierarchy.leaders.size());
+        leaderModels[0] = mobilitySuperLeader;
+        for (uint32_t l = 1; l < hierarchy.leaders.size(); ++l) {
+            const HierarchyLeader& leader = hierarchy.leaders[l];
+            Ptr<FormationMobilityModel> formation = CreateObject<FormationMobilityModel>();
+            formation->SetReference(leaderModels[leader.parent], leader.offset);
+            leader.node->AggregateObject(formation);
+            leaderModels[l] = formation;
+        }
+
+        for (const HierarchyCluster& cluster : hierarchy.clusters) {
+            for (uint32_t i = 0; i < cluster.followers.GetN(); ++i) {
+                Ptr<PursuitFollowerMobilityModel> follower = CreateObject<PursuitFollowerMobilityModel>();
+                follower->SetAttribute("Speed", DoubleValue(followerSpeed));
+                follower->SetAttribute("Noise", DoubleValue(noiseFactor));
+                follower->SetLeader(leaderModels[cluster.leader]);
+                cluster.followers.Get(i)->AggregateObject(follower);
+            }
+        }
+    } else {
+        // lideres mobilidad
+
+        Ptr<PositionAllocator> positionAlloc = CreateObject<RandomRectanglePositionAllocator>();
+        positionAlloc->SetAttribute("X", StringValue("ns3::UniformRandomVariable[Min=0.0|Max=200.0]"));
+        positionAlloc->SetAttribute("Y", StringValue("ns3::UniformRandomVariable[Min=0.0|Max=200.0]"));
+
+        MobilityHelper mobilityLeaders;
+        mobilityLeaders.SetMobilityModel("ns3::RandomWaypointMobilityModel",
+            "Speed", StringValue("ns3::UniformRandomVariable[Min=0.5|Max=1.5]"), // movimiento lento
+            "Pause", StringValue("ns3::ConstantRandomVariable[Constant=5.0]"),  // pausas realistas
+            "PositionAllocator", PointerValue(positionAlloc));
+
+
+        mobilityLeaders.SetPositionAllocator(positionAlloc);
+        for (uint32_t l = 1; l < hierarchy.leaders.size(); ++l) {
+            mobilityLeaders.Install(hierarchy.leaders[l].node);
+        }
+
+        MobilityHelper mobility;
+        // seguidores mobilidad
+        // Sampled animation must not see the per-tick teleports as course changes
+        mobility.SetMobilityModel(config.anim == "positions" ? "SilentPositionMobilityModel" : "ns3::ConstantPositionMobilityModel");
+        mobility.Install(hierarchy.followerNodes);
+    }
     
     std::cout << "Hola desde el simulador" << std::endl;
     
@@ -176,145 +1225,483 @@ void RunSimulation(uint32_t nodesPerCluster, double simulationTime, double areaS
     wifiChannel.AddPropagationLoss("ns3::LogDistancePropagationLossModel");
     wifiChannel.SetPropagationDelay("ns3::ConstantSpeedPropagationDelayModel");
 
-    YansWifiPhyHelper wifiPhy;
-    wifiPhy.SetChannel(wifiChannel.Create());
+    // With the split plan the backbone and every cluster get their own 20 MHz
+    // channel number, so a frame only reaches radios of its subnet; leaders hold
+    // one radio per channel. Past the 5 GHz list the numbers are reused
+    // round-robin, and subnets on the same number share one channel object,
+    // so they interfere with each other as they would on air.
+    static const uint16_t channelNumbers[] = {36, 40, 44, 48, 52, 56, 60, 64, 100, 104, 108, 112, 116,
+                                              120, 124, 128, 132, 136, 140, 144, 149, 153, 157, 161, 165};
+    const uint32_t numChannelNumbers = sizeof(channelNumbers) / sizeof(channelNumbers[0]);
+    const bool splitChannels = (config.channelPlan == "split");
+    YansWifiPhyHelper yansPhy;
+    SpectrumWifiPhyHelper spectrumPhy;
+    std::vector<Ptr<GridSpectrumChannel>> gridChannels;    // One per channel number in use
+    std::vector<Ptr<YansWifiChannel>> yansChannels;        // One per channel number in use
+    std::vector<Ptr<CachedPropagationLossModel>> lossCaches;
+    uint32_t channelCount = 0;
+    auto selectChannel = [&]() {
+        if (channelCount > 0 && !splitChannels) {
+            return; // Shared plan: every subnet stays on the first channel
+        }
+        uint32_t slot = channelCount % numChannelNumbers;
+        if (channelCount >= numChannelNumbers) {
+            // Channel number already in use: join its medium
+            if (config.channel == "grid") {
+                spectrumPhy.SetChannel(gridChannels[slot]);
+            } else {
+                yansPhy.SetChannel(yansChannels[slot]);
+            }
+            std::ostringstream settings;
+            settings << "{" << channelNumbers[slot] << ", 20, BAND_5GHZ, 0}";
+            yansPhy.Set("ChannelSettings", StringValue(settings.str()));
+            spectrumPhy.Set("ChannelSettings", StringValue(settings.str()));
+            ++channelCount;
+            return;
+        }
+        // Same loss chain as the Yans helper: Default() log-distance + the added log-distance
+        Ptr<PropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel>();
+        loss->SetNext(CreateObject<LogDistancePropagationLossModel>());
+        if (config.lossCache) {
+            Ptr<CachedPropagationLossModel> cache = CreateObject<CachedPropagationLossModel>();
+            cache->SetInner(loss);
+            lossCaches.push_back(cache);
+            loss = cache;
+        }
+        if (config.channel == "grid") {
+            Ptr<GridSpectrumChannel> gridChannel = CreateObject<GridSpectrumChannel>();
+            gridChannel->SetAttribute("MaxNodeSpeed", DoubleValue(maxNodeSpeed));
+            gridChannel->AddPropagationLossModel(loss);
+            gridChannel->SetPropagationDelayModel(CreateObject<ConstantSpeedPropagationDelayModel>());
+            spectrumPhy.SetChannel(gridChannel);
+            gridChannels.push_back(gridChannel);
+        } else if (config.lossCache) {
+            Ptr<YansWifiChannel> yansChannel = CreateObject<YansWifiChannel>();
+            yansChannel->SetPropagationLossModel(loss);
+            yansChannel->SetPropagationDelayModel(CreateObject<ConstantSpeedPropagationDelayModel>());
+            yansPhy.SetChannel(yansChannel);
+            yansChannels.push_back(yansChannel);
+        } else {
+            Ptr<YansWifiChannel> yansChannel = wifiChannel.Create();
+            yansPhy.SetChannel(yansChannel);
+            yansChannels.push_back(yansChannel);
+        }
+        if (splitChannels) {
+            std::ostringstream settings;
+            settings << "{" << channelNumbers[slot] << ", 20, BAND_5GHZ, 0}";
+            yansPhy.Set("ChannelSettings", StringValue(settings.str()));
+            spectrumPhy.Set("ChannelSettings", StringValue(settings.str()));
+        }
+        ++channelCount;
+    };
+    const WifiPhyHelper& wifiPhy = (config.channel == "grid") ? static_cast<const WifiPhyHelper&>(spectrumPhy)
+                                                              : static_cast<const WifiPhyHelper&>(yansPhy);
     WifiMacHelper wifiMac;
     wifiMac.SetType("ns3::AdhocWifiMac");
     WifiHelper wifi;
     wifi.SetStandard(WIFI_STANDARD_80211n);
-    
+
+    // --- Wi-Fi Devices (backbone + one per cluster) ---
+    // Installed here so PHY and channel construction count as topology setup.
+    selectChannel();
+    NetDeviceContainer backboneDevices = wifi.Install(wifiPhy, wifiMac, hierarchy.leaderNodes);
+    std::vector<NetDeviceContainer> clusterDevices;
+    for (const HierarchyCluster& cluster : hierarchy.clusters) {
+        selectChannel();
+        clusterDevices.push_back(wifi.Install(wifiPhy, wifiMac, cluster.nodes));
+    }
+    std::cout << "Channel plan: " << config.channelPlan << " (" << channelCount << " channel"
+              << (channelCount == 1 ? "" : "s") << ")" << std::endl;
+    if (!gridChannels.empty()) {
+        std::cout << "Grid channel range: " << gridChannels.front()->GetRange() << " m" << std::endl;
+    }
+
+    topologyTime = SecondsSince(&phaseMark);
+
     // --- Network Stack and Protocol Setup ---
+    // OLSR announces the cluster subnets through HNA. AODV and DSDV route to
+    // every interface address on all nodes, which already covers the clusters.
     InternetStackHelper internet;
     OlsrHelper olsr;
-    internet.SetRoutingHelper(olsr);
-    internet.Install(superLeaderContainer);
-    internet.Install(clusterLeadersContainer);
-    internet.Install(followersA);
-    internet.Install(followersB);
+    AodvHelper aodv;
+    DsdvHelper dsdv;
+    Ipv4StaticRoutingHelper staticRouting;
+    const bool olsrRouting = (config.routing == "olsr" || config.routing == "static-hier");
+    const bool hierarchicalRouting = (config.routing == "static-hier");
+    if (hierarchicalRouting) {
+        // OLSR runs on the backbone only: the cluster interface of a leaf leader
+        // (index 2, after the loopback and the backbone) is left to static routing,
+        // which holds the connected cluster subnet.
+        for (const HierarchyCluster& cluster : hierarchy.clusters) {
+            olsr.ExcludeInterface(hierarchy.leaders[cluster.leader].node, 2);
+        }
+        Ipv4ListRoutingHelper leaderRouting;
+        leaderRouting.Add(staticRouting, 0);
+        leaderRouting.Add(olsr, 10);
+        internet.SetRoutingHelper(leaderRouting);
+        internet.Install(hierarchy.leaderNodes);
 
-    // --- IP Addressing (3 Subnets) ---
+        InternetStackHelper followerStack;
+        followerStack.SetRoutingHelper(staticRouting);
+        followerStack.Install(hierarchy.followerNodes);
+    } else {
+        if (config.routing == "aodv") {
+            internet.SetRoutingHelper(aodv);
+        } else if (config.routing == "dsdv") {
+            internet.SetRoutingHelper(dsdv);
+        } else {
+            internet.SetRoutingHelper(olsr);
+        }
+        internet.Install(hierarchy.leaderNodes);
+        internet.Install(hierarchy.followerNodes);
+    }
+
+    // --- IP Addressing (backbone + one subnet per cluster) ---
     Ipv4AddressHelper address;
     
-    // Subnet 1: Backbone network for leaders
-    address.SetBase("192.168.1.0", "255.255.255.0");
-    NetDeviceContainer backboneDevices = wifi.Install(wifiPhy, wifiMac, NodeContainer(superLeader, clusterLeaderA, clusterLeaderB));
+    // Backbone network for all leaders
+    if (hierarchy.leaderNodes.GetN() <= 254) {
+        address.SetBase("192.168.1.0", "255.255.255.0");
+    } else {
+        NS_ABORT_MSG_IF(hierarchy.leaderNodes.GetN() > 65534, "Too many leaders for the backbone subnet");
+        address.SetBase("172.16.0.0", "255.255.0.0");
+    }
     Ipv4InterfaceContainer backboneInterfaces = address.Assign(backboneDevices);
 
-    // Subnet 2: Cluster A network
-    address.SetBase("10.1.1.0", "255.255.255.0");
-    NetDeviceContainer clusterADevices = wifi.Install(wifiPhy, wifiMac, clusterA_nodes);
-    Ipv4InterfaceContainer clusterAInterfaces = address.Assign(clusterADevices);
-    std::cout<< "Cluster A IP in BASE: 10.1.1.0" << std::endl;
-
-    // Subnet 3: Cluster B network
-    address.SetBase("10.1.2.0", "255.255.255.0");
-    NetDeviceContainer clusterBDevices = wifi.Install(wifiPhy, wifiMac, clusterB_nodes);
-    Ipv4InterfaceContainer clusterBInterfaces = address.Assign(clusterBDevices);
+    // One subnet per cluster; the leader is the last address
+    for (uint32_t c = 0; c < hierarchy.clusters.size(); ++c) {
+        HierarchyCluster& cluster = hierarchy.clusters[c];
+        address.SetBase(cluster.network, cluster.mask);
+        Ipv4InterfaceContainer clusterInterfaces = address.Assign(clusterDevices[c]);
+        cluster.leaderAddress = clusterInterfaces.GetAddress(cluster.nodes.GetN() - 1);
+        NS_LOG_INFO("Cluster IP in BASE: " << cluster.network << ", leader IP: " << cluster.leaderAddress);
+    }
     
     
     // --- Enable IP Forwarding and Configure HNA for Inter-Cluster Routing ---
     // Leaders need IP forwarding to route packets between their interfaces.
-    superLeader->GetObject<Ipv4>()->SetAttribute("IpForward", BooleanValue(true));
-    clusterLeaderA->GetObject<Ipv4>()->SetAttribute("IpForward", BooleanValue(true));
-    clusterLeaderB->GetObject<Ipv4>()->SetAttribute("IpForward", BooleanValue(true));
+    for (const HierarchyLeader& leader : hierarchy.leaders) {
+        leader.node->GetObject<Ipv4>()->SetAttribute("IpForward", BooleanValue(true));
+    }
 
-    // Cluster Leader A advertises its local network (10.1.1.0/24) to the backbone.
-    Ptr<olsr::RoutingProtocol> olsrA = clusterLeaderA->GetObject<Ipv4>()->GetRoutingProtocol()->GetObject<olsr::RoutingProtocol>();
-    olsrA->AddHostNetworkAssociation(Ipv4Address("10.1.1.0"), Ipv4Mask("255.255.255.0"));
-    
-    // Cluster Leader B advertises its local network (10.1.2.0/24) to the backbone.
-    Ptr<olsr::RoutingProtocol> olsrB = clusterLeaderB->GetObject<Ipv4>()->GetRoutingProtocol()->GetObject<olsr::RoutingProtocol>();
-    olsrB->AddHostNetworkAssociation(Ipv4Address("10.1.2.0"), Ipv4Mask("255.255.255.0"));
+    // Each cluster leader advertises its local network to the backbone.
+    for (uint32_t c = 0; olsrRouting && c < hierarchy.clusters.size(); ++c) {
+        const HierarchyCluster& cluster = hierarchy.clusters[c];
+        Ptr<Node> leaderNode = hierarchy.leaders[cluster.leader].node;
+        Ptr<olsr::RoutingProtocol> olsrLeader = FindOlsr(leaderNode);
+        NS_ABORT_MSG_IF(!olsrLeader, "Cluster leader " << leaderNode->GetId() << " does not run OLSR");
+        olsrLeader->AddHostNetworkAssociation(cluster.network, cluster.mask);
+    }
+
+    // Hierarchical routing: followers send everything through their leader.
+    if (hierarchicalRouting) {
+        for (const HierarchyCluster& cluster : hierarchy.clusters) {
+            for (uint32_t i = 0; i < cluster.followers.GetN(); ++i) {
+                Ptr<Ipv4> ipv4 = cluster.followers.Get(i)->GetObject<Ipv4>();
+                staticRouting.GetStaticRouting(ipv4)->SetDefaultRoute(cluster.leaderAddress, 1);
+            }
+        }
+    }
+
+    // --- Routing Control Overhead ---
+    ControlOverheadCounter overhead(NodeList::GetNNodes());
+    // One counting point for every scheme: IP Tx filtered on the control port.
+    uint16_t controlPort = olsrRouting ? 698 : (config.routing == "aodv") ? 654 : 269; // OLSR / AODV / DSDV
+    for (uint32_t n = 0; n < NodeList::GetNNodes(); ++n) {
+        NodeList::GetNode(n)->GetObject<Ipv4L3Protocol>()->TraceConnectWithoutContext("Tx", MakeBoundCallback(&RoutingControlTxTrace, &overhead, controlPort, n));
+        if (!olsrRouting) {
+            continue;
+        }
+        Ptr<olsr::RoutingProtocol> nodeOlsr = FindOlsr(NodeList::GetNode(n));
+        if (nodeOlsr) {
+            nodeOlsr->TraceConnectWithoutContext("Tx", MakeBoundCallback(&OlsrTxTrace, &overhead, n));
+            nodeOlsr->TraceConnectWithoutContext("RoutingTableChanged", MakeBoundCallback(&OlsrRoutingTableTrace, &overhead, n));
+        }
+    }
+
+    stackTime = SecondsSince(&phaseMark);
 
     // --- Application Setup (Telemetria desde seguidores a lideres)
     
     uint16_t telemetryPort = 9;
 
+    // Both ends carry a SeqTsSizeHeader so the collector sees the send time of every packet
+    // A warm-start parent writes nothing; its children reopen the collector.
+    TelemetryCollector collector(config, runNumber, (config.window > 0 && warmStart == nullptr) ? config.windowsFile + fileSuffix : "");
+
     // --- Sink apps en líderes ---
     PacketSinkHelper sink("ns3::UdpSocketFactory", InetSocketAddress(Ipv4Address::GetAny(), telemetryPort));
+    sink.SetAttribute("EnableSeqTsSizeHeader", BooleanValue(true));
 
     ApplicationContainer sinkApps;
-    sinkApps.Add(sink.Install(clusterLeaderA));
-    sinkApps.Add(sink.Install(clusterLeaderB));
+    for (const HierarchyCluster& cluster : hierarchy.clusters) {
+        sinkApps.Add(sink.Install(hierarchy.leaders[cluster.leader].node));
+    }
+    for (uint32_t i = 0; i < sinkApps.GetN(); ++i) {
+        sinkApps.Get(i)->TraceConnectWithoutContext("RxWithSeqTsSize", MakeBoundCallback(&TelemetryRxTrace, &collector));
+    }
     sinkApps.Start(Seconds(1.0));
     sinkApps.Stop(Seconds(simulationTime));
 
-    // --- Telemetría desde seguidores A hacia clusterLeaderA ---
-    Ipv4Address leaderAIp = clusterAInterfaces.GetAddress(0); 
-    std::cout<< "Leader A IP: " << leaderAIp << std::endl;
-    for (uint32_t i = 0; i < followersA.GetN(); ++i) {
-        OnOffHelper source("ns3::UdpSocketFactory", InetSocketAddress(leaderAIp, telemetryPort));
-        source.SetConstantRate(DataRate("256kbps"));
-        source.SetAttribute("PacketSize", UintegerValue(packetSizei));
-        ApplicationContainer app = source.Install(followersA.Get(i));
-        app.Start(Seconds(2.0));
-        app.Stop(Seconds(simulationTime - 2.0));
-    }
-
-    // --- Telemetría desde seguidores B hacia clusterLeaderB ---
-    Ipv4Address leaderBIp = clusterBInterfaces.GetAddress(0); // Última IP = líder
-    for (uint32_t i = 0; i < followersB.GetN(); ++i) {
-        OnOffHelper source("ns3::UdpSocketFactory", InetSocketAddress(leaderBIp, telemetryPort));
-        source.SetConstantRate(DataRate("256kbps"));
-        source.SetAttribute("PacketSize", UintegerValue(packetSizei));
-        ApplicationContainer app = source.Install(followersB.Get(i));
-        app.Start(Seconds(2.0));
-        app.Stop(Seconds(simulationTime - 2.0));
-    }
-
-
-
-    std::stringstream animFileName;
-    animFileName << "HierarchicalMobility_" << packetSizei << ".xml";
-    AnimationInterface anim(animFileName.str());
-    anim.SetConstantPosition(superLeader, 10, 10); // Initial placeholder positions
-    anim.SetConstantPosition(clusterLeaderA, 20, 20);
-    anim.SetConstantPosition(clusterLeaderB, 30, 30);
+    // --- Uplink de agregación (líderes -> super-líder) ---
+    // Each cluster leader batches what its sink receives and sends it over the
+    // backbone to the super-leader, which measures the goodput and the
+    // follower-to-super-leader latency of every record. Sink i is cluster i.
+    uint16_t uplinkPort = 10;
+    UplinkStats uplink = UplinkStats();
+    std::vector<Ptr<TelemetryAggregator>> aggregators;
+    if (config.uplinkBatch > 0) {
+        PacketSinkHelper uplinkSink("ns3::UdpSocketFactory", InetSocketAddress(Ipv4Address::GetAny(), uplinkPort));
+        ApplicationContainer uplinkSinkApps = uplinkSink.Install(superLeader);
+        uplinkSinkApps.Get(0)->TraceConnectWithoutContext("Rx", MakeBoundCallback(&UplinkRxTrace, &uplink));
+        uplinkSinkApps.Start(Seconds(1.0));
+        uplinkSinkApps.Stop(Seconds(simulationTime));
+        for (uint32_t c = 0; c < hierarchy.clusters.size(); ++c) {
+            Ptr<TelemetryAggregator> aggregator = CreateObject<TelemetryAggregator>();
+            aggregator->SetAttribute("Remote", AddressValue(InetSocketAddress(backboneInterfaces.GetAddress(0), uplinkPort)));
+            aggregator->SetAttribute("BatchSize", UintegerValue(config.uplinkBatch));
+            aggregator->SetAttribute("FlushDeadline", TimeValue(Seconds(config.uplinkDeadline)));
+            hierarchy.leaders[hierarchy.clusters[c].leader].node->AddApplication(aggregator);
+            aggregator->SetStartTime(Seconds(1.0));
+            aggregator->SetStopTime(Seconds(simulationTime - 1.0)); // Last batch lands before the sink stops
+            sinkApps.Get(c)->TraceConnectWithoutContext("RxWithSeqTsSize", MakeBoundCallback(&AggregatorRxTrace, PeekPointer(aggregator)));
+            aggregators.push_back(aggregator);
+        }
+    }
+
+    // --- Telemetría desde seguidores hacia su líder de cluster ---
+    // Installed when the telemetry starts; an application added during the run
+    // is initialized at once, so Start/Stop are relative to now.
+    ApplicationContainer sourceApps;
+    double trafficStartTime = -1.0;
+    auto installSources = [&](Time start) {
+        Time now = Simulator::Now();
+        Time stop = Seconds(simulationTime - 2.0);
+        if (start >= stop) {
+            return; // No time left for telemetry
+        }
+        trafficStartTime = start.GetSeconds();
+        for (uint32_t c = 0; c < hierarchy.clusters.size(); ++c) {
+            const HierarchyCluster& cluster = hierarchy.clusters[c];
+            for (uint32_t i = 0; i < cluster.followers.GetN(); ++i) {
+                OnOffHelper source("ns3::UdpSocketFactory", InetSocketAddress(cluster.leaderAddress, telemetryPort));
+                source.SetConstantRate(DataRate(static_cast<uint64_t>(config.followerRate * 1000.0)));
+                source.SetAttribute("PacketSize", UintegerValue(packetSizei));
+                source.SetAttribute("EnableSeqTsSizeHeader", BooleanValue(true));
+                ApplicationContainer app = source.Install(cluster.followers.Get(i));
+                sourceApps.Add(app);
+                app.Start(start - now);
+                app.Stop(stop - now);
+
+                // Followers have a single device, interface 1 (0 is the loopback)
+                Ipv4Address followerAddress = cluster.followers.Get(i)->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal();
+                uint32_t flow = collector.AddFlow(c, followerAddress);
+                app.Get(0)->TraceConnectWithoutContext("TxWithSeqTsSize", MakeBoundCallback(&TelemetryTxTrace, &collector, flow));
+            }
+        }
+    };
+
+    // --- Routing Convergence ---
+    // Followers need a route to their leader, leaders one to the super-leader.
+    // With --trafficStart=auto the telemetry starts when all of them exist
+    // (not before the sinks, not after the timeout); otherwise the monitor
+    // only measures. The first check comes after the warm-start fork point.
+    // AODV finds routes on demand, so there is nothing to wait for: the
+    // monitor is not started, the telemetry starts at the first check time
+    // and the convergence time stays -1 (not applicable).
+    double convergenceInterval = 0.1; // seconds
+    RouteConvergenceMonitor convergence(Seconds(convergenceInterval), Seconds(config.convergenceTimeout));
+    bool reactiveRouting = (config.routing == "aodv");
+    if (!reactiveRouting) {
+        for (const HierarchyCluster& cluster : hierarchy.clusters) {
+            for (uint32_t i = 0; i < cluster.followers.GetN(); ++i) {
+                convergence.AddRoute(cluster.followers.Get(i), cluster.leaderAddress);
+            }
+        }
+        for (uint32_t l = 1; l < hierarchy.leaders.size(); ++l) {
+            convergence.AddRoute(hierarchy.leaders[l].node, backboneInterfaces.GetAddress(0));
+        }
+    }
+    Time firstCheck = std::max(Seconds(1.0), Seconds(config.warmStart + convergenceInterval));
+    if (reactiveRouting) {
+        installSources(config.trafficStart < 0 ? firstCheck : Seconds(config.trafficStart));
+    } else if (config.trafficStart < 0) {
+        convergence.Start(firstCheck, [&]() { installSources(Simulator::Now()); });
+    } else {
+        installSources(Seconds(config.trafficStart));
+        convergence.Start(firstCheck, nullptr);
+    }
+
+
+
+    // --- Animation (NetAnim) ---
+    std::unique_ptr<AnimationInterface> anim;
+    AnimPacketCap animCap = {nullptr, config.animMaxPackets};
+    if (config.anim != "off") {
+        anim.reset(new AnimationInterface(AnimFileName(config, runNumber)));
+        anim->SetMobilityPollInterval(Seconds(config.animInterval));
+        anim->SetConstantPosition(superLeader, 10, 10); // Initial placeholder positions
+        for (uint32_t l = 1; l < hierarchy.leaders.size(); ++l) {
+            anim->SetConstantPosition(hierarchy.leaders[l].node, 10.0 + 10.0 * l, 10.0 + 10.0 * l);
+        }
+        if (config.anim == "positions") {
+            anim->SkipPacketTracing();
+        } else if (config.animMaxPackets > 0) {
+            animCap.anim = anim.get();
+            Config::ConnectWithoutContext("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyTxBegin",
+                                          MakeBoundCallback(&AnimPacketCapTrace, &animCap));
+        }
+    }
     
     // --- Schedule Mobility Updates ---
     double updateInterval = 0.1; // seconds
-    Simulator::Schedule(Seconds(updateInterval), &UpdateHierarchicalMobility, superLeader, clusterLeaderA, clusterLeaderB, followersA, followersB, followerSpeed, noiseFactor);
+    HierarchicalMobilityController mobilityController(hierarchy, followerSpeed, noiseFactor, Seconds(updateInterval), SelectFollowerStepKernel(config.mobilityKernel));
+    if (!analyticMobility) {
+        mobilityController.Start();
+    }
     
     std::cout << "Fin de configuracion de simulacion, empezando simulacion" << std::endl;
     // --- Post-Simulation Analysis ---
     FlowMonitorHelper flowmon;
     Ptr<FlowMonitor> monitor = flowmon.InstallAll();
 
-    // --- Run Simulation ---
-    Simulator::Stop(Seconds(simulationTime));
-    Simulator::Run();
+    appsTime = SecondsSince(&phaseMark);
 
-    std::cout << "Fin simulacion, datos" << std::endl;
-    
-    monitor->CheckForLostPackets();
-    Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier>(flowmon.GetClassifier());
-    FlowMonitor::FlowStatsContainer stats = monitor->GetFlowStats();
+    // --- Warm Start ---
+    // Run the shared part once, then continue every variant in its own child.
+    uint32_t variantIndex = 0;
+    if (warmStart != nullptr) {
+        Simulator::Stop(Seconds(config.warmStart));
+        Simulator::Run();
+        std::cout << "Warm start: scenario at t=" << Simulator::Now().GetSeconds() << " s after "
+                  << SecondsSince(&phaseMark) << " s, forking " << warmStart->variants.size() << " variants" << std::endl;
 
-    // --- CSV File Setup ---
-    std::stringstream ss;
-    // Using packetSizei in the filename as it's the varying parameter for analysis
-    ss << "hierarchical_manet_stats_packetSize_" << packetSizei << ".csv"; 
-    std::string csvFileName = ss.str();
-    std::ofstream outFile;
-    
-    // Check if the file already exists to decide whether to write header
-    std::ifstream testFile(csvFileName);
-    bool fileExists = testFile.good();
-    testFile.close(); // Close the test file stream
+        uint32_t failedChildren = 0;
+        auto waitForChild = [&failedChildren]() {
+            int status = 0;
+            pid_t pid;
+            while ((pid = wait(&status)) < 0 && errno == EINTR) {
+            }
+            if (pid < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                ++failedChildren;
+            }
+        };
+        uint32_t running = 0;
+        pid_t pid = 1;
+        for (uint32_t v = 0; v < warmStart->variants.size() && pid != 0; ++v) {
+            if (running >= std::max<uint32_t>(warmStart->jobs, 1)) {
+                waitForChild();
+                --running;
+            }
+            std::cout.flush(); // Do not let the child inherit buffered output
+            pid = fork();
+            NS_ABORT_MSG_IF(pid < 0, "fork() failed for warm-start variant " << v);
+            if (pid == 0) {
+                variantIndex = warmStart->variants[v];
+            } else {
+                ++running;
+            }
+        }
+        if (pid != 0) {
+            while (running > 0) {
+                waitForChild();
+                --running;
+            }
+            Simulator::Destroy();
+            NS_ABORT_MSG_IF(failedChildren > 0, failedChildren << " warm-start variants failed");
+            return RunSummary();
+        }
 
-    if (!fileExists) {
-        // File doesn't exist, create it and write the header
-        outFile.open(csvFileName, std::ios_base::out);
-        // Added 'RunNumber' to the header
-        outFile << "RunNumber,NodesPerCluster,SimTime,AreaSize,FollowerSpeed,NoiseFactor,PacketSize,"
-                << "FlowID,SourceAddress,DestinationAddress,TxPackets,RxPackets,TxBytes,RxBytes,"
-                << "PacketDeliveryRatio,AvgLatency_ms,AvgThroughput_kbps" << std::endl;
+        // --- Variant Parameters (child) ---
+        const SimulationTask& variant = (*warmStart->tasks)[variantIndex];
+        config = variant.config;
+        runNumber = variant.runNumber;
+        fileSuffix = TaskPartSuffix(variantIndex);
+        packetSizei = config.packetSizei;
+        std::cout << "Warm-start variant: run " << runNumber << ", packet size " << packetSizei
+                  << ", rate " << config.followerRate << " kbps" << std::endl;
+        for (uint32_t a = 0; a < sourceApps.GetN(); ++a) {
+            sourceApps.Get(a)->SetAttribute("PacketSize", UintegerValue(packetSizei));
+            sourceApps.Get(a)->SetAttribute("DataRate", DataRateValue(DataRate(static_cast<uint64_t>(config.followerRate * 1000.0))));
+        }
+        // Every variant has the warm-up's run number, so the random streams
+        // simply continue, as in a cold run of the same task.
+        collector.Reopen(runNumber, config.window > 0 ? config.windowsFile + fileSuffix : "");
+        ResetPeakRss();
+        SecondsSince(&phaseMark);
+    }
+
+    // --- Run Simulation ---
+    Simulator::Stop(Seconds(simulationTime) - Simulator::Now());
+    g_eventProfile = config.profile ? &eventProfile : nullptr;
+    Simulator::Run();
+    eventProfile.EndEvent();
+    g_eventProfile = nullptr;
+    runTime = SecondsSince(&phaseMark);
+    uint64_t events = Simulator::GetEventCount();
+    mobilityController.Stop();
+    if (reactiveRouting) {
+        std::cout << "Routes discovered on demand (" << config.routing << "); telemetry from " << trafficStartTime << " s" << std::endl;
     } else {
-        // File exists, open in append mode
-        outFile.open(csvFileName, std::ios_base::app);
+        std::cout << "Routes for " << convergence.GetRoutes() << " nodes "
+                  << (convergence.GetConvergenceTime() >= 0 ? "converged at " : "not converged, timeout ")
+                  << (convergence.GetConvergenceTime() >= 0 ? convergence.GetConvergenceTime() : config.convergenceTimeout)
+                  << " s (" << convergence.GetChecks() << " lookups); telemetry from " << trafficStartTime << " s" << std::endl;
+    }
+    if (config.profile) {
+        eventProfile.Report(std::cout, "hierarchical_manet_profile_" + RunFileStem(config, runNumber) + ".csv");
+    }
+    collector.Finish();
+    if (config.window > 0) {
+        std::cout << "Streamed " << collector.GetWindows() << " metric windows of " << config.window << " s" << std::endl;
+    }
+
+    if (!analyticMobility) {
+        std::cout << "Mobility ticks: " << mobilityController.GetTicks();
+#ifdef MANET_COUNT_ALLOCATIONS
+        std::cout << ", heap allocations during ticks: " << mobilityController.GetTickAllocations();
+#endif
+        std::cout << std::endl;
     }
+    if (!gridChannels.empty()) {
+        uint64_t transmissions = 0;
+        uint64_t evaluated = 0;
+        uint64_t pruned = 0;
+        for (const Ptr<GridSpectrumChannel>& gridChannel : gridChannels) {
+            transmissions += gridChannel->GetTransmissions();
+            evaluated += gridChannel->GetEvaluatedReceivers();
+            pruned += gridChannel->GetPrunedReceivers();
+        }
+        std::cout << "Grid channel: " << transmissions << " transmissions, "
+                  << evaluated << " receivers evaluated, "
+                  << pruned << " pruned by distance" << std::endl;
+    }
+    if (!lossCaches.empty()) {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        for (const Ptr<CachedPropagationLossModel>& cache : lossCaches) {
+            hits += cache->GetHits();
+            misses += cache->GetMisses();
+        }
+        double hitRate = (hits + misses > 0) ? 100.0 * hits / (hits + misses) : 0.0;
+        std::cout << "Loss cache: " << hits << " hits, " << misses << " misses ("
+                  << hitRate << "% hit rate)" << std::endl;
+    }
+
+    std::cout << "Fin simulacion, datos" << std::endl;
+    
+    monitor->CheckForLostPackets();
+    Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier>(flowmon.GetClassifier());
+    FlowMonitor::FlowStatsContainer stats = monitor->GetFlowStats();
 
-    std::cout << "Writing statistics to " << csvFileName << "..." << std::endl;
+    // --- Results Block (one per run, appended in a single write) ---
+    ResultsBlock results(FlowResultsSchema());
+    uint64_t runId = NewRunId(); // Drawn after the fork, so warm-start variants differ
+    std::string fanoutLabel = FanoutLabel(config.clusterFanout);
+
+    RunSummary summary = RunSummary();
+    uint64_t dataBytes = 0; // Telemetry bytes sent, IP level
+    uint32_t latencyFlows = 0; // Flows with a latency (at least one packet received)
 
     for (auto it = stats.begin(); it != stats.end(); ++it) {
         Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(it->first);
@@ -337,32 +1724,518 @@ void RunSimulation(uint32_t nodesPerCluster, double simulationTime, double areaS
         
         double flowDuration = (it->second.timeLastRxPacket.GetSeconds() - it->second.timeFirstTxPacket.GetSeconds());
         double avgThroughput = (flowDuration > 0) ? (rxBytes * 8.0) / (flowDuration * 1000.0) : 0.0;
+
+        dataBytes += txBytes;
+        summary.flows++;
+        summary.pdr += pdr;
+        summary.avgLatency += avgLatency;
+        summary.avgThroughput += avgThroughput;
         
-        // --- Write Data Row to CSV File ---
-        outFile << runNumber << "," // Added runNumber
-                << nodesPerCluster << ","
-                << simulationTime << ","
-                << areaSize << ","
-                << followerSpeed << ","
-                << noiseFactor << ","
-                << packetSizei << ","
-                << it->first << ","
-                << t.sourceAddress << ","
-                << t.destinationAddress << ","
-                << txPackets << ","
-                << rxPackets << ","
-                << txBytes << ","
-                << rxBytes << ","
-                << std::fixed << std::setprecision(2) << pdr << ","
-                << std::fixed << std::setprecision(2) << avgLatency << ","
-                << std::fixed << std::setprecision(2) << avgThroughput
-                << std::endl;
+        // --- Add Data Row (column order of FlowResultsSchema) ---
+        results.PutU32(0, runNumber);
+        results.PutU32(1, nodesPerCluster);
+        results.PutF64(2, simulationTime);
+        results.PutF64(3, areaSize);
+        results.PutF64(4, followerSpeed);
+        results.PutF64(5, noiseFactor);
+        results.PutU32(6, packetSizei);
+        results.PutU32(7, it->first);
+        results.PutU32(8, t.sourceAddress.Get());
+        results.PutU32(9, t.destinationAddress.Get());
+        results.PutU32(10, txPackets);
+        results.PutU32(11, rxPackets);
+        results.PutU64(12, txBytes);
+        results.PutU64(13, rxBytes);
+        results.PutF64(14, pdr);
+        results.PutF64(15, avgLatency);
+        results.PutF64(16, avgThroughput);
+        const LatencyHistogram* latency = collector.FindLatencyHistogram(t.sourceAddress);
+        double p95Latency = latency ? latency->GetPercentileMs(95.0) : 0.0;
+        if (rxPackets > 0) {
+            summary.p95Latency += p95Latency; // A flow with nothing received has no latency, not 0 ms
+            ++latencyFlows;
+        }
+        results.PutF64(17, latency ? latency->GetPercentileMs(50.0) : 0.0);
+        results.PutF64(18, p95Latency);
+        results.PutF64(19, latency ? latency->GetPercentileMs(99.0) : 0.0);
+        results.PutF64(20, latency ? latency->GetMaxMs() : 0.0);
+        for (uint32_t c = 21; c <= 25; ++c) {
+            results.PutF64(c, 0.0); // Run cost, filled in below once the export is timed
+        }
+        results.PutU64(26, 0);
+        results.PutU64(27, 0);
+        results.PutF64(28, config.followerRate);
+        results.PutF64(29, convergence.GetConvergenceTime());
+        results.PutF64(30, trafficStartTime);
+        for (uint32_t c = 31; c <= 37; ++c) {
+            results.PutU64(c, 0); // Routing overhead of the run, filled in below
+        }
+        results.PutF64(38, 0.0);
+        results.PutU64(39, 0);
+        for (uint32_t c = 40; c <= 43; ++c) {
+            results.PutU64(c, 0); // Aggregation uplink of the run, filled in below
+        }
+        for (uint32_t c = 44; c <= 46; ++c) {
+            results.PutF64(c, 0.0);
+        }
+        results.PutU64(47, runId);
+        results.PutLabel(48, config.routing);
+        results.PutLabel(49, fanoutLabel);
+        results.PutLabel(50, config.channel);
+        results.PutLabel(51, config.channelPlan);
+        results.PutLabel(52, config.mobility);
+        results.PutLabel(53, config.scheduler);
+        NS_ABORT_MSG_IF(!results.EndRow(), "Results row does not match the schema");
     }
-    outFile.close();
+
+    // --- Routing Overhead Columns ---
+    ControlOverheadCounter::Counters control = overhead.GetTotal();
+    double controlDataRatio = dataBytes > 0 ? static_cast<double>(control.bytes) / dataBytes : 0.0;
+    results.FillU64(31, control.helloMessages);
+    results.FillU64(32, control.helloBytes);
+    results.FillU64(33, control.tcMessages);
+    results.FillU64(34, control.tcBytes);
+    results.FillU64(35, control.hnaMessages);
+    results.FillU64(36, control.hnaBytes);
+    results.FillU64(37, control.bytes);
+    results.FillF64(38, controlDataRatio);
+    results.FillU64(39, control.recomputations);
+    std::cout << "Routing control (" << config.routing << "): " << control.helloMessages << " HELLO, " << control.tcMessages << " TC, "
+              << control.hnaMessages << " HNA messages, " << control.bytes << " bytes (control/data "
+              << controlDataRatio << "), " << control.recomputations << " routing-table computations" << std::endl;
+
+    // --- Aggregation Uplink Columns ---
+    uint64_t uplinkRecordsSent = 0;
+    for (const Ptr<TelemetryAggregator>& aggregator : aggregators) {
+        uplinkRecordsSent += aggregator->GetRecordsSent();
+    }
+    double uplinkDuration = (uplink.lastRx - uplink.firstRx).GetSeconds();
+    double backboneGoodput = (uplinkDuration > 0) ? (uplink.recordBytes * 8.0) / (uplinkDuration * 1000.0) : 0.0;
+    double uplinkLatencyAvg = (uplink.records > 0) ? uplink.delaySum.GetSeconds() * 1000.0 / uplink.records : 0.0;
+    double uplinkLatencyP95 = uplink.latency.GetPercentileMs(95.0);
+    results.FillU64(40, uplinkRecordsSent);
+    results.FillU64(41, uplink.records);
+    results.FillU64(42, uplink.batches);
+    results.FillU64(43, uplink.bytes);
+    results.FillF64(44, backboneGoodput);
+    results.FillF64(45, uplinkLatencyAvg);
+    results.FillF64(46, uplinkLatencyP95);
+    if (config.uplinkBatch > 0) {
+        uint64_t uplinkBatchesSent = 0;
+        for (const Ptr<TelemetryAggregator>& aggregator : aggregators) {
+            uplinkBatchesSent += aggregator->GetBatchesSent();
+        }
+        std::cout << "Uplink: " << uplink.records << "/" << uplinkRecordsSent << " records in " << uplink.batches
+                  << "/" << uplinkBatchesSent << " batches of up to " << config.uplinkBatch << " (" << uplink.bytes << " bytes), goodput "
+                  << backboneGoodput << " kbps, latency avg " << uplinkLatencyAvg << " ms, p95 "
+                  << uplinkLatencyP95 << " ms" << std::endl;
+    }
+
+    // --- Per-Node Overhead Rows ---
+    ResultsBlock nodeRows(NodeResultsSchema());
+    auto addNodeRow = [&](Ptr<Node> node, uint32_t role) {
+        const ControlOverheadCounter::Counters& counters = overhead.GetNode(node->GetId());
+        nodeRows.PutU32(0, runNumber);
+        nodeRows.PutU32(1, nodesPerCluster);
+        nodeRows.PutU32(2, packetSizei);
+        nodeRows.PutF64(3, config.followerRate);
+        nodeRows.PutU32(4, node->GetId());
+        nodeRows.PutU32(5, role);
+        nodeRows.PutU32(6, node->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal().Get());
+        nodeRows.PutU64(7, counters.helloMessages);
+        nodeRows.PutU64(8, counters.helloBytes);
+        nodeRows.PutU64(9, counters.tcMessages);
+        nodeRows.PutU64(10, counters.tcBytes);
+        nodeRows.PutU64(11, counters.hnaMessages);
+        nodeRows.PutU64(12, counters.hnaBytes);
+        nodeRows.PutU64(13, counters.packets);
+        nodeRows.PutU64(14, counters.bytes);
+        nodeRows.PutU64(15, counters.recomputations);
+        nodeRows.PutU64(16, runId);
+        nodeRows.PutLabel(17, config.routing);
+        nodeRows.PutLabel(18, fanoutLabel);
+        nodeRows.PutLabel(19, config.channel);
+        nodeRows.PutLabel(20, config.channelPlan);
+        nodeRows.PutLabel(21, config.mobility);
+        nodeRows.PutLabel(22, config.scheduler);
+        nodeRows.PutF64(23, simulationTime);
+        nodeRows.PutF64(24, areaSize);
+        nodeRows.PutF64(25, followerSpeed);
+        nodeRows.PutF64(26, noiseFactor);
+        NS_ABORT_MSG_IF(!nodeRows.EndRow(), "Node row does not match the schema");
+    };
+    for (uint32_t l = 0; l < hierarchy.leaders.size(); ++l) {
+        addNodeRow(hierarchy.leaders[l].node, l == 0 ? 0 : 1);
+    }
+    for (uint32_t i = 0; i < hierarchy.followerNodes.GetN(); ++i) {
+        addNodeRow(hierarchy.followerNodes.Get(i), 2);
+    }
+
+    // --- Run Cost Columns ---
+    // The export phase ends here, before the block is written.
+    exportTime = SecondsSince(&phaseMark);
+    uint64_t peakRss = PeakRssKb();
+    results.FillF64(21, topologyTime);
+    results.FillF64(22, stackTime);
+    results.FillF64(23, appsTime);
+    results.FillF64(24, runTime);
+    results.FillF64(25, exportTime);
+    results.FillU64(26, peakRss);
+    results.FillU64(27, events);
+    std::cout << "Phases (s): topology " << topologyTime << ", stack " << stackTime << ", apps " << appsTime
+              << ", run " << runTime << ", export " << exportTime << "; peak RSS " << peakRss << " kB, "
+              << events << " events" << std::endl;
+
+    std::string resultsFileName = config.resultsFile + fileSuffix;
+    std::cout << "Writing statistics to " << resultsFileName << "..." << std::endl;
+    std::string resultsError;
+    NS_ABORT_MSG_IF(!AppendResultsBlock(resultsFileName, results, &resultsError), resultsError);
+    NS_ABORT_MSG_IF(!AppendResultsBlock(config.nodesFile + fileSuffix, nodeRows, &resultsError), resultsError);
     std::cout << "Statistics saved." << std::endl;
+    WriteRunManifest(config, runNumber, runId, config.manifestFile + fileSuffix);
+
+    if (summary.flows > 0) {
+        summary.pdr /= summary.flows;
+        summary.avgLatency /= summary.flows;
+        summary.avgThroughput /= summary.flows;
+    }
+    summary.p95Latency = (latencyFlows > 0) ? summary.p95Latency / latencyFlows : std::numeric_limits<double>::infinity();
+    summary.nodes = NodeList::GetNNodes();
+    summary.setupTime = topologyTime + stackTime + appsTime;
+    summary.runTime = runTime;
+    summary.events = events;
+    summary.peakRssKb = peakRss;
+    summary.convergenceTime = convergence.GetConvergenceTime();
+    summary.controlBytes = control.bytes;
+    summary.controlDataRatio = controlDataRatio;
+    summary.wallTime = topologyTime + stackTime + appsTime + runTime + exportTime;
+    summary.valid = true;
 
     // --- Cleanup ---
     Simulator::Destroy(); // Destroy the simulator instance for the next run
+    if (warmStart != nullptr) {
+        // Warm-start child: hand the summary to the parent process and leave
+        warmStart->summaries[variantIndex] = summary;
+        std::cout.flush();
+        _exit(0);
+    }
+    return summary;
+}
+
+/**
+ * @brief Number of leaf clusters described by the fan-out of each level.
+ */
+uint32_t CountClusters(const SimulationConfig& config) {
+    uint32_t clusters = 1;
+    for (uint32_t fanout : config.clusterFanout) {
+        clusters *= fanout;
+    }
+    return clusters;
+}
+
+/**
+ * @brief OLSR instance of a node, installed alone or inside a list routing; null if none.
+ */
+Ptr<olsr::RoutingProtocol> FindOlsr(Ptr<Node> node) {
+    Ptr<Ipv4RoutingProtocol> routing = node->GetObject<Ipv4>()->GetRoutingProtocol();
+    Ptr<olsr::RoutingProtocol> olsrRouting = DynamicCast<olsr::RoutingProtocol>(routing);
+    Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting>(routing);
+    for (uint32_t i = 0; !olsrRouting && list && i < list->GetNRoutingProtocols(); ++i) {
+        int16_t priority;
+        olsrRouting = DynamicCast<olsr::RoutingProtocol>(list->GetRoutingProtocol(i, priority));
+    }
+    return olsrRouting;
+}
+
+/**
+ * @brief Number of leaders (super-leader included) described by the fan-out of each level.
+ */
+uint32_t CountLeaders(const SimulationConfig& config) {
+    uint32_t leaders = 1;
+    uint32_t levelSize = 1;
+    for (uint32_t fanout : config.clusterFanout) {
+        levelSize *= fanout;
+        leaders += levelSize;
+    }
+    return leaders;
+}
+
+/**
+ * @brief Creates the nodes of the hierarchy and computes formations and subnets.
+ *
+ * The super-leader has clusterFanout[0] children, each of those has
+ * clusterFanout[1] children and so on; the leaders of the last level head
+ * the clusters, each with nodesPerCluster - 1 followers. Children are spread
+ * evenly on a ring around their parent, starting at 225 degrees, with radius
+ * formationRadius[level] (default 50*sqrt(2) m at the first level, halved
+ * at every further level). The default two clusters therefore sit at the
+ * historical (-50, -50) and (50, 50) offsets.
+ *
+ * Nodes are created in the historical order (super-leader, leaders, then
+ * followers cluster by cluster) so node ids stay stable. Cluster c gets
+ * 10.1.(c + 1).0/24 (continuing into 10.2.x.0 past 255 clusters), or
+ * 10.(c + 1).0.0/16 when clusters exceed 254 nodes.
+ */
+Hierarchy BuildHierarchy(const SimulationConfig& config) {
+    Hierarchy hierarchy;
+
+    // --- Leaders, breadth-first ---
+    NodeContainer leaderNodes;
+    leaderNodes.Create(CountLeaders(config));
+    hierarchy.leaders.push_back({leaderNodes.Get(0), -1, 0, Vector(0, 0, 0), -1});
+
+    uint32_t levelBegin = 0;
+    for (uint32_t level = 1; level <= config.clusterFanout.size(); ++level) {
+        uint32_t fanout = config.clusterFanout[level - 1];
+        double radius = (level - 1 < config.formationRadius.size()) ? config.formationRadius[level - 1]
+                                                                    : 50.0 * std::sqrt(2.0) / std::pow(2.0, level - 1);
+        uint32_t levelEnd = hierarchy.leaders.size();
+        for (uint32_t parent = levelBegin; parent < levelEnd; ++parent) {
+            for (uint32_t j = 0; j < fanout; ++j) {
+                double angle = (225.0 - 360.0 * j / fanout) * M_PI / 180.0;
+                // Rounded to the nanometre so the default formation is exactly +-50 m
+                Vector offset(std::round(radius * std::cos(angle) * 1e9) / 1e9,
+                              std::round(radius * std::sin(angle) * 1e9) / 1e9, 0);
+                hierarchy.leaders.push_back({leaderNodes.Get(hierarchy.leaders.size()), static_cast<int32_t>(parent), level, offset, -1});
+            }
+        }
+        levelBegin = levelEnd;
+    }
+    hierarchy.leaderNodes = leaderNodes;
+
+    // --- Clusters under the last level of leaders ---
+    bool smallClusters = (config.nodesPerCluster <= 254);
+    for (uint32_t l = levelBegin; l < hierarchy.leaders.size(); ++l) {
+        uint32_t c = hierarchy.clusters.size();
+        hierarchy.leaders[l].cluster = c;
+
+        HierarchyCluster cluster;
+        cluster.leader = l;
+        std::stringstream network;
+        if (smallClusters) {
+            NS_ABORT_MSG_IF(c + 1 >= 254 * 256, "Too many clusters for 10.0.0.0/8");
+            network << "10." << (1 + (c + 1) / 256) << "." << ((c + 1) % 256) << ".0";
+            cluster.mask = Ipv4Mask("255.255.255.0");
+        } else {
+            NS_ABORT_MSG_IF(c + 1 >= 255, "Too many large clusters for 10.0.0.0/8");
+            network << "10." << (c + 1) << ".0.0";
+            cluster.mask = Ipv4Mask("255.255.0.0");
+        }
+        cluster.network = Ipv4Address(network.str().c_str());
+        hierarchy.clusters.push_back(cluster);
+    }
+
+    // --- Followers, cluster by cluster ---
+    for (HierarchyCluster& cluster : hierarchy.clusters) {
+        cluster.followers.Create(config.nodesPerCluster - 1); // -1 because the leader is also part of the cluster
+        cluster.nodes = cluster.followers;
+        cluster.nodes.Add(hierarchy.leaders[cluster.leader].node);
+        hierarchy.followerNodes.Add(cluster.followers);
+    }
+    return hierarchy;
+}
+
+/**
+ * @brief Per-run part of output file names: the run number and every parameter
+ * a sweep or benchmark varies.
+ *
+ * Besides the sweep grid this covers the leader tree (fanout per level) and
+ * simulation time of the scaling benchmark, the scheduler and routing scheme
+ * of their benchmarks, and the channel and mobility modes, so no two runs of
+ * one invocation write the same NetAnim or profile file.
+ */
+std::string RunFileStem(const SimulationConfig& config, uint32_t runNumber) {
+    std::stringstream ss;
+    ss << "n" << config.nodesPerCluster << "_v" << config.followerSpeed << "_e" << config.noiseFactor
+       << "_p" << config.packetSizei << "_r" << config.followerRate << "_f" << FanoutLabel(config.clusterFanout)
+       << "_t" << config.simulationTime << "_" << config.channel << "-" << config.channelPlan << "_" << config.mobility
+       << "_" << config.scheduler << "_" << config.routing << "_run" << runNumber;
+    return ss.str();
+}
+
+/**
+ * @brief Leader tree of a scenario as one label, e.g. "10x4" for --clusterFanout=10,4.
+ */
+std::string FanoutLabel(const std::vector<uint32_t>& clusterFanout) {
+    std::ostringstream label;
+    for (uint32_t i = 0; i < clusterFanout.size(); ++i) {
+        label << (i > 0 ? "x" : "") << clusterFanout[i];
+    }
+    return label.str();
+}
+
+/**
+ * @brief NetAnim file of one run.
+ */
+std::string AnimFileName(const SimulationConfig& config, uint32_t runNumber) {
+    return "HierarchicalMobility_" + RunFileStem(config, runNumber) + ".xml";
+}
+
+/**
+ * @brief PhyTxBegin sink that turns NetAnim packet tracing off once the cap is reached.
+ */
+void AnimPacketCapTrace(AnimPacketCap* cap, Ptr<const Packet> packet, double txPowerW) {
+    if (cap->anim == nullptr) {
+        return;
+    }
+    if (cap->remaining > 0) {
+        --cap->remaining;
+    }
+    if (cap->remaining == 0) {
+        cap->anim->SkipPacketTracing(); // Later transmissions are no longer written
+        cap->anim = nullptr;
+    }
+}
+
+/**
+ * @brief ns-3 TypeId name of a --scheduler value.
+ */
+std::string SchedulerTypeName(const std::string& scheduler) {
+    if (scheduler == "map") {
+        return "ns3::MapScheduler";
+    } else if (scheduler == "heap") {
+        return "ns3::HeapScheduler";
+    } else if (scheduler == "list") {
+        return "ns3::ListScheduler";
+    } else if (scheduler == "calendar") {
+        return "ns3::CalendarScheduler";
+    }
+    NS_ABORT_MSG("Unknown --scheduler=" << scheduler);
+    return "";
+}
+
+/**
+ * @brief Seconds elapsed since `*mark`, which is then moved to now.
+ */
+double SecondsSince(std::chrono::steady_clock::time_point* mark) {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(now - *mark).count();
+    *mark = now;
+    return seconds;
+}
+
+/**
+ * @brief Resets the process peak RSS (Linux clear_refs), so PeakRssKb() covers the current run only.
+ *
+ * Without clear_refs support the peak stays the process-wide maximum.
+ */
+void ResetPeakRss() {
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    if (clearRefs.good()) {
+        clearRefs << "5";
+    }
+}
+
+/**
+ * @brief Peak resident set size in kB since the last ResetPeakRss() (VmHWM), 0 if unknown.
+ */
+uint64_t PeakRssKb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::strtoull(line.c_str() + 6, nullptr, 10);
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief GNU build id of the running executable as hex, or the compile date if it has none.
+ */
+std::string BinaryBuildId() {
+    std::string buildId;
+    dl_iterate_phdr([](struct dl_phdr_info* info, size_t, void* data) -> int {
+        std::string* id = static_cast<std::string*>(data);
+        for (int h = 0; h < info->dlpi_phnum; ++h) {
+            if (info->dlpi_phdr[h].p_type != PT_NOTE) {
+                continue;
+            }
+            const char* note = reinterpret_cast<const char*>(info->dlpi_addr + info->dlpi_phdr[h].p_vaddr);
+            const char* end = note + info->dlpi_phdr[h].p_memsz;
+            while (note + sizeof(ElfW(Nhdr)) <= end) {
+                const ElfW(Nhdr)* header = reinterpret_cast<const ElfW(Nhdr)*>(note);
+                const char* name = note + sizeof(ElfW(Nhdr));
+                const unsigned char* desc = reinterpret_cast<const unsigned char*>(name + ((header->n_namesz + 3) & ~3u));
+                if (header->n_type == NT_GNU_BUILD_ID && header->n_namesz == 4 && std::memcmp(name, "GNU", 4) == 0) {
+                    static const char hex[] = "0123456789abcdef";
+                    for (uint32_t i = 0; i < header->n_descsz; ++i) {
+                        id->push_back(hex[desc[i] >> 4]);
+                        id->push_back(hex[desc[i] & 0xf]);
+                    }
+                    return 1;
+                }
+                note = reinterpret_cast<const char*>(desc) + ((header->n_descsz + 3) & ~3u);
+            }
+        }
+        return 1; // The first object is the executable itself
+    }, &buildId);
+    return buildId.empty() ? std::string("built ") + __DATE__ + " " + __TIME__ : buildId;
+}
+
+/**
+ * @brief Every parameter of a scenario as one JSON object.
+ */
+std::string ConfigJson(const SimulationConfig& config) {
+    std::ostringstream outFile;
+    outFile << "{\"nodesPerCluster\":" << config.nodesPerCluster
+            << ",\"simTime\":" << config.simulationTime
+            << ",\"areaSize\":" << config.areaSize
+            << ",\"followerSpeed\":" << config.followerSpeed
+            << ",\"noiseFactor\":" << config.noiseFactor
+            << ",\"packetSizei\":" << config.packetSizei
+            << ",\"followerRate\":" << config.followerRate
+            << ",\"mobility\":\"" << config.mobility << "\""
+            << ",\"mobilityKernel\":\"" << config.mobilityKernel << "\"";
+    outFile << ",\"clusterFanout\":[";
+    for (uint32_t i = 0; i < config.clusterFanout.size(); ++i) {
+        outFile << (i > 0 ? "," : "") << config.clusterFanout[i];
+    }
+    outFile << "],\"formationRadius\":[";
+    for (uint32_t i = 0; i < config.formationRadius.size(); ++i) {
+        outFile << (i > 0 ? "," : "") << config.formationRadius[i];
+    }
+    outFile << "],\"channel\":\"" << config.channel << "\""
+            << ",\"channelPlan\":\"" << config.channelPlan << "\""
+            << ",\"lossCache\":" << (config.lossCache ? "true" : "false")
+            << ",\"anim\":\"" << config.anim << "\""
+            << ",\"window\":" << config.window
+            << ",\"scheduler\":\"" << config.scheduler << "\""
+            << ",\"routing\":\"" << config.routing << "\""
+            << ",\"profile\":" << (config.profile ? "true" : "false")
+            << ",\"warmStart\":" << config.warmStart
+            << ",\"trafficStart\":" << config.trafficStart
+            << ",\"convergenceTimeout\":" << config.convergenceTimeout
+            << ",\"uplinkBatch\":" << config.uplinkBatch
+            << ",\"uplinkDeadline\":" << config.uplinkDeadline
+            << "}";
+    return outFile.str();
+}
+
+/**
+ * @brief Identifier of one run, unique across sweeps, benchmarks and processes.
+ *
+ * Taken from the OS entropy source, not the ns-3 streams, so it does not
+ * perturb the simulation. Kept to 53 bits so JSON readers parse it exactly.
+ */
+uint64_t NewRunId() {
+    std::random_device entropy;
+    uint64_t id = (static_cast<uint64_t>(entropy()) << 32) | entropy();
+    return id & ((static_cast<uint64_t>(1) << 53) - 1);
+}
+
+/**
+ * @brief Appends one JSON line with the run id, seed, every parameter and the build id of a run.
+ */
+void WriteRunManifest(const SimulationConfig& config, uint32_t runNumber, uint64_t runId, const std::string& fileName) {
+    static const std::string buildId = BinaryBuildId();
+    std::ofstream outFile(fileName, std::ios_base::app);
+    outFile << "{\"runId\":" << runId
+            << ",\"runNumber\":" << runNumber
+            << ",\"seed\":" << RngSeedManager::GetSeed()
+            << ",\"rngRun\":" << RngSeedManager::GetRun()
+            << ",\"buildId\":\"" << buildId << "\""
+            << ",\"parameters\":" << ConfigJson(config) << "}\n";
 }
 
 ns3::Vector Normalize(const ns3::Vector& v) {
@@ -374,58 +2247,2412 @@ ns3::Vector Normalize(const ns3::Vector& v) {
 //================================================================================
 
 /**
- * @brief Periodically updates the positions of all nodes according to the hierarchical model.
+ * @brief Portable follower update, one follower at a time (see FollowerStepKernel).
+ */
+void FollowerStepScalar(double* x, double* y, double* vx, double* vy, uint32_t n, double leaderX, double leaderY, double speed, double dt) {
+    for (uint32_t i = 0; i < n; ++i) {
+        double dx = leaderX - x[i];
+        double dy = leaderY - y[i];
+        double mag = std::sqrt(dx * dx + dy * dy);
+        double ux = (mag != 0) ? dx / mag : 0.0;
+        double uy = (mag != 0) ? dy / mag : 0.0;
+        vx[i] = ux * speed + vx[i];
+        vy[i] = uy * speed + vy[i];
+        x[i] = x[i] + vx[i] * dt; // Simple Euler integration
+        y[i] = y[i] + vy[i] * dt;
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+/**
+ * @brief SSE2 follower update, two followers per instruction (see FollowerStepKernel).
+ */
+__attribute__((target("sse2")))
+void FollowerStepSse2(double* x, double* y, double* vx, double* vy, uint32_t n, double leaderX, double leaderY, double speed, double dt) {
+    const __m128d lx = _mm_set1_pd(leaderX);
+    const __m128d ly = _mm_set1_pd(leaderY);
+    const __m128d sp = _mm_set1_pd(speed);
+    const __m128d step = _mm_set1_pd(dt);
+    const __m128d zero = _mm_setzero_pd();
+    uint32_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d px = _mm_loadu_pd(x + i);
+        __m128d py = _mm_loadu_pd(y + i);
+        __m128d dx = _mm_sub_pd(lx, px);
+        __m128d dy = _mm_sub_pd(ly, py);
+        __m128d mag = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)));
+        __m128d atLeader = _mm_cmpeq_pd(mag, zero); // Zero direction where the division is 0/0
+        __m128d ux = _mm_andnot_pd(atLeader, _mm_div_pd(dx, mag));
+        __m128d uy = _mm_andnot_pd(atLeader, _mm_div_pd(dy, mag));
+        __m128d velX = _mm_add_pd(_mm_mul_pd(ux, sp), _mm_loadu_pd(vx + i));
+        __m128d velY = _mm_add_pd(_mm_mul_pd(uy, sp), _mm_loadu_pd(vy + i));
+        _mm_storeu_pd(vx + i, velX);
+        _mm_storeu_pd(vy + i, velY);
+        _mm_storeu_pd(x + i, _mm_add_pd(px, _mm_mul_pd(velX, step)));
+        _mm_storeu_pd(y + i, _mm_add_pd(py, _mm_mul_pd(velY, step)));
+    }
+    FollowerStepScalar(x + i, y + i, vx + i, vy + i, n - i, leaderX, leaderY, speed, dt);
+}
+
+/**
+ * @brief AVX2 follower update, four followers per instruction (see FollowerStepKernel).
+ */
+__attribute__((target("avx2")))
+void FollowerStepAvx2(double* x, double* y, double* vx, double* vy, uint32_t n, double leaderX, double leaderY, double speed, double dt) {
+    const __m256d lx = _mm256_set1_pd(leaderX);
+    const __m256d ly = _mm256_set1_pd(leaderY);
+    const __m256d sp = _mm256_set1_pd(speed);
+    const __m256d step = _mm256_set1_pd(dt);
+    const __m256d zero = _mm256_setzero_pd();
+    uint32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d px = _mm256_loadu_pd(x + i);
+        __m256d py = _mm256_loadu_pd(y + i);
+        __m256d dx = _mm256_sub_pd(lx, px);
+        __m256d dy = _mm256_sub_pd(ly, py);
+        __m256d mag = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+        __m256d atLeader = _mm256_cmp_pd(mag, zero, _CMP_EQ_OQ); // Zero direction where the division is 0/0
+        __m256d ux = _mm256_andnot_pd(atLeader, _mm256_div_pd(dx, mag));
+        __m256d uy = _mm256_andnot_pd(atLeader, _mm256_div_pd(dy, mag));
+        __m256d velX = _mm256_add_pd(_mm256_mul_pd(ux, sp), _mm256_loadu_pd(vx + i));
+        __m256d velY = _mm256_add_pd(_mm256_mul_pd(uy, sp), _mm256_loadu_pd(vy + i));
+        _mm256_storeu_pd(vx + i, velX);
+        _mm256_storeu_pd(vy + i, velY);
+        _mm256_storeu_pd(x + i, _mm256_add_pd(px, _mm256_mul_pd(velX, step)));
+        _mm256_storeu_pd(y + i, _mm256_add_pd(py, _mm256_mul_pd(velY, step)));
+    }
+    FollowerStepSse2(x + i, y + i, vx + i, vy + i, n - i, leaderX, leaderY, speed, dt);
+}
+#endif
+
+/**
+ * @brief Returns the follower kernel for `name` (auto, avx2, sse2 or scalar).
+ *
+ * "auto" picks the widest kernel the CPU supports. Asking for a kernel the
+ * CPU or the build cannot run is an error rather than a silent fallback.
+ */
+FollowerStepKernel SelectFollowerStepKernel(const std::string& name) {
+#if defined(__x86_64__) || defined(__i386__)
+    bool hasAvx2 = __builtin_cpu_supports("avx2");
+    bool hasSse2 = __builtin_cpu_supports("sse2");
+    if (name == "avx2" || (name == "auto" && hasAvx2)) {
+        NS_ABORT_MSG_IF(!hasAvx2, "--mobilityKernel=avx2 is not supported by this CPU");
+        return &FollowerStepAvx2;
+    }
+    if (name == "sse2" || (name == "auto" && hasSse2)) {
+        NS_ABORT_MSG_IF(!hasSse2, "--mobilityKernel=sse2 is not supported by this CPU");
+        return &FollowerStepSse2;
+    }
+#endif
+    NS_ABORT_MSG_IF(name != "auto" && name != "scalar", "Unknown or unavailable --mobilityKernel=" << name);
+    return &FollowerStepScalar;
+}
+
+HierarchicalMobilityController::HierarchicalMobilityController(const Hierarchy& hierarchy, double followerSpeed, double noiseFactor, Time interval, FollowerStepKernel kernel)
+    : m_kernel(kernel),
+      m_followerSpeed(followerSpeed),
+      m_noiseFactor(noiseFactor),
+      m_interval(interval),
+      m_running(false),
+      m_ticks(0),
+      m_tickAllocations(0) {
+    // --- Cache the mobility models once ---
+    for (const HierarchyLeader& leader : hierarchy.leaders) {
+        m_leaders.push_back(leader.node->GetObject<MobilityModel>());
+        m_parents.push_back(leader.parent);
+        m_offsets.push_back(leader.offset);
+    }
+    m_leaderPositions.resize(m_leaders.size());
+
+    m_clusterBegin.push_back(0);
+    for (const HierarchyCluster& cluster : hierarchy.clusters) {
+        for (uint32_t i = 0; i < cluster.followers.GetN(); ++i) {
+            m_followers.push_back(cluster.followers.Get(i)->GetObject<MobilityModel>());
+        }
+        m_clusterBegin.push_back(m_followers.size());
+        m_clusterLeader.push_back(cluster.leader);
+    }
+
+    // --- Structure-of-arrays follower state ---
+    m_x.resize(m_followers.size());
+    m_y.resize(m_followers.size());
+    m_z.resize(m_followers.size());
+    m_vx.resize(m_followers.size());
+    m_vy.resize(m_followers.size());
+
+    m_noise = CreateObject<UniformRandomVariable>();
+    m_tickEvent = Create<TickEvent>(this);
+}
+
+/**
+ * @brief Schedules the first tick one interval from now.
+ */
+void HierarchicalMobilityController::Start() {
+    for (uint32_t i = 0; i < m_followers.size(); ++i) {
+        Vector position = m_followers[i]->GetPosition();
+        m_x[i] = position.x;
+        m_y[i] = position.y;
+        m_z[i] = position.z;
+    }
+    m_running = true;
+    Simulator::Schedule(m_interval, m_tickEvent);
+}
+
+/**
+ * @brief Stops rescheduling; a tick already in the queue becomes a no-op.
+ */
+void HierarchicalMobilityController::Stop() {
+    m_running = false;
+}
+
+uint64_t HierarchicalMobilityController::GetTicks() const {
+    return m_ticks;
+}
+
+uint64_t HierarchicalMobilityController::GetTickAllocations() const {
+    return m_tickAllocations;
+}
+
+HierarchicalMobilityController::TickEvent::TickEvent(HierarchicalMobilityController* controller)
+    : m_controller(controller) {
+}
+
+void HierarchicalMobilityController::TickEvent::Notify() {
+    m_controller->Tick();
+}
+
+/**
+ * @brief Updates the positions of all nodes according to the hierarchical model.
  *
  * 1.  It gets the Super-Leader's current position.
- * 2.  It sets the Cluster-Leaders' positions to maintain a fixed formation around the Super-Leader.
- * 3.  It updates the velocity of follower nodes to move towards their respective Cluster-Leader.
- *
- * @param superLeader Pointer to the top-level leader node.
- * @param clusterLeaderA Pointer to the leader of cluster A.
- * @param clusterLeaderB Pointer to the leader of cluster B.
- * @param followersA NodeContainer for followers in cluster A.
- * @param followersB NodeContainer for followers in cluster B.
- * @param followerSpeed The speed of follower nodes.
- * @param noiseFactor The randomness factor in follower movement.
- */
-void UpdateHierarchicalMobility(Ptr<Node> superLeader, Ptr<Node> clusterLeaderA, Ptr<Node> clusterLeaderB, NodeContainer followersA, NodeContainer followersB, double followerSpeed, double noiseFactor) {
-    // --- Get Current Position of Super-Leader (Level 2) ---
-    Vector superLeaderPos = superLeader->GetObject<MobilityModel>()->GetPosition();
-
-    // --- Update Cluster-Leader Positions (Level 1 Mobility) ---
-    // They maintain a fixed offset from the super-leader, creating a formation.
-    Vector offsetA(-50, -50, 0); // Cluster A is bottom-left of the super-leader
-    Vector offsetB(50, 50, 0);   // Cluster B is top-right of the super-leader
-    
-    Ptr<MobilityModel> mobilityA = clusterLeaderA->GetObject<MobilityModel>();
-    mobilityA->SetPosition(superLeaderPos + offsetA);
-
-    Ptr<MobilityModel> mobilityB = clusterLeaderB->GetObject<MobilityModel>();
-    mobilityB->SetPosition(superLeaderPos + offsetB);
-
-    // --- Update Follower Velocities (Level 0 Mobility) ---
-    Ptr<UniformRandomVariable> noise = CreateObject<UniformRandomVariable>();
-
-    // Update followers in Cluster A
-    Vector leaderAPos = mobilityA->GetPosition();
-    for (uint32_t i = 0; i < followersA.GetN(); ++i) {
-        Ptr<MobilityModel> followerMobility = followersA.Get(i)->GetObject<MobilityModel>();
-        Vector followerPos = followerMobility->GetPosition();
-        Vector direction = leaderAPos - followerPos;
-        Vector velocity = Normalize(direction) * followerSpeed + Vector(noise->GetValue(-noiseFactor, noiseFactor), noise->GetValue(-noiseFactor, noiseFactor), 0);
-        followerMobility->SetPosition(followerPos + velocity * 0.1); // Simple Euler integration
-    }
-
-    // Update followers in Cluster B
-    Vector leaderBPos = mobilityB->GetPosition();
-    for (uint32_t i = 0; i < followersB.GetN(); ++i) {
-        Ptr<MobilityModel> followerMobility = followersB.Get(i)->GetObject<MobilityModel>();
-        Vector followerPos = followerMobility->GetPosition();
-        Vector direction = leaderBPos - followerPos;
-        Vector velocity = Normalize(direction) * followerSpeed + Vector(noise->GetValue(-noiseFactor, noiseFactor), noise->GetValue(-noiseFactor, noiseFactor), 0);
-        followerMobility->SetPosition(followerPos + velocity * 0.1); // Simple Euler integration
+ * 2.  It walks the leader tree breadth-first, placing every leader at its
+ *     formation offset from its (already updated) parent.
+ * 3.  It moves follower nodes towards their respective Cluster-Leader.
+ *
+ * Noise is drawn in the same order as a per-node loop would (x then y,
+ * follower by follower, cluster by cluster) and the kernels evaluate the same
+ * floating point operations as Normalize(), so every kernel produces the
+ * same trajectories. Followers are planar: z is carried but not integrated.
+ *
+ * With -DMANET_COUNT_ALLOCATIONS the heap allocations of the whole tick are
+ * counted, the reschedule included (an insertion into the event scheduler,
+ * which allocates with some schedulers), as well as anything done by
+ * CourseChange observers (e.g. NetAnim) and by the mobility models.
+ */
+void HierarchicalMobilityController::Tick() {
+    if (!m_running) {
+        return;
     }
-    
-    // Re-schedule this function to maintain continuous movement.
-    Simulator::Schedule(Seconds(0.1), &UpdateHierarchicalMobility, superLeader, clusterLeaderA, clusterLeaderB, followersA, followersB, followerSpeed, noiseFactor);
+#ifdef MANET_COUNT_ALLOCATIONS
+    uint64_t allocationsBefore = g_heapAllocations;
+#endif
+    ++m_ticks;
+
+    // --- Get Current Position of Super-Leader (top level) ---
+    m_leaderPositions[0] = m_leaders[0]->GetPosition();
+
+    // --- Update Leader Positions (one pass over the tree) ---
+    // They maintain a fixed offset from their parent, creating a formation.
+    for (uint32_t l = 1; l < m_leaders.size(); ++l) {
+        m_leaders[l]->SetPosition(m_leaderPositions[m_parents[l]] + m_offsets[l]);
+        m_leaderPositions[l] = m_leaders[l]->GetPosition();
+    }
+
+    // --- Follower noise (Level 0 Mobility) ---
+    for (uint32_t i = 0; i < m_followers.size(); ++i) {
+        m_vx[i] = m_noise->GetValue(-m_noiseFactor, m_noiseFactor);
+        m_vy[i] = m_noise->GetValue(-m_noiseFactor, m_noiseFactor);
+    }
+
+    // --- Update Followers (Level 0 Mobility) ---
+    for (uint32_t c = 0; c < m_clusterLeader.size(); ++c) {
+        const Vector& leaderPos = m_leaderPositions[m_clusterLeader[c]];
+        uint32_t begin = m_clusterBegin[c];
+        if (begin == m_clusterBegin[c + 1]) {
+            continue;
+        }
+        m_kernel(&m_x[begin], &m_y[begin], &m_vx[begin], &m_vy[begin], m_clusterBegin[c + 1] - begin,
+                 leaderPos.x, leaderPos.y, m_followerSpeed, m_interval.GetSeconds());
+    }
+
+    // --- Write back to the mobility models in one batch ---
+    for (uint32_t i = 0; i < m_followers.size(); ++i) {
+        m_followers[i]->SetPosition(Vector(m_x[i], m_y[i], m_z[i]));
+    }
+
+    // Re-schedule the same event to maintain continuous movement.
+    Simulator::Schedule(m_interval, m_tickEvent);
+#ifdef MANET_COUNT_ALLOCATIONS
+    m_tickAllocations += g_heapAllocations - allocationsBefore;
+#endif
+}
+
+//================================================================================
+// 7. ANALYTIC (EVENT-FREE) MOBILITY MODELS
+//================================================================================
+
+NS_OBJECT_ENSURE_REGISTERED(FormationMobilityModel);
+
+TypeId FormationMobilityModel::GetTypeId() {
+    static TypeId tid = TypeId("FormationMobilityModel")
+        .SetParent<MobilityModel>()
+        .SetGroupName("Mobility")
+        .AddConstructor<FormationMobilityModel>();
+    return tid;
+}
+
+FormationMobilityModel::FormationMobilityModel() : m_offset(0, 0, 0) {
+}
+
+/**
+ * @brief Sets the node this model follows and the fixed offset kept from it.
+ */
+void FormationMobilityModel::SetReference(Ptr<MobilityModel> reference, const Vector& offset) {
+    m_reference = reference;
+    m_offset = offset;
+    NotifyCourseChange();
+}
+
+Vector FormationMobilityModel::DoGetPosition() const {
+    return m_reference->GetPosition() + m_offset;
+}
+
+void FormationMobilityModel::DoSetPosition(const Vector& position) {
+    // Positions are relative to the reference: setting one moves the formation slot.
+    m_offset = position - m_reference->GetPosition();
+    NotifyCourseChange();
+}
+
+Vector FormationMobilityModel::DoGetVelocity() const {
+    return m_reference->GetVelocity();
+}
+
+NS_OBJECT_ENSURE_REGISTERED(PursuitFollowerMobilityModel);
+
+TypeId PursuitFollowerMobilityModel::GetTypeId() {
+    static TypeId tid = TypeId("PursuitFollowerMobilityModel")
+        .SetParent<MobilityModel>()
+        .SetGroupName("Mobility")
+        .AddConstructor<PursuitFollowerMobilityModel>()
+        .AddAttribute("Speed", "Pursuit speed towards the leader in m/s.",
+                      DoubleValue(1.5),
+                      MakeDoubleAccessor(&PursuitFollowerMobilityModel::m_speed),
+                      MakeDoubleChecker<double>(0.0))
+        .AddAttribute("Noise", "Amplitude of the uniform velocity noise per axis in m/s.",
+                      DoubleValue(1.0),
+                      MakeDoubleAccessor(&PursuitFollowerMobilityModel::m_noiseFactor),
+                      MakeDoubleChecker<double>(0.0))
+        .AddAttribute("Step", "Integration step of the pursuit dynamics.",
+                      TimeValue(Seconds(0.1)),
+                      MakeTimeAccessor(&PursuitFollowerMobilityModel::m_step),
+                      MakeTimeChecker());
+    return tid;
+}
+
+PursuitFollowerMobilityModel::PursuitFollowerMobilityModel()
+    : m_speed(1.5),
+      m_noiseFactor(1.0),
+      m_step(Seconds(0.1)),
+      m_lastUpdate(Seconds(0.0)),
+      m_position(0, 0, 0),
+      m_velocity(0, 0, 0),
+      m_lastLeaderPos(0, 0, 0) {
+    m_noise = CreateObject<UniformRandomVariable>();
+}
+
+/**
+ * @brief Sets the mobility model of the leader this follower pursues.
+ */
+void PursuitFollowerMobilityModel::SetLeader(Ptr<MobilityModel> leader) {
+    m_leader = leader;
+    m_lastLeaderPos = leader->GetPosition();
+}
+
+/**
+ * @brief Advances the state over every whole step elapsed since the last evaluation.
+ */
+void PursuitFollowerMobilityModel::Update() const {
+    int64_t steps = (Simulator::Now() - m_lastUpdate).GetTimeStep() / m_step.GetTimeStep();
+    if (steps <= 0) {
+        return;
+    }
+    double dt = m_step.GetSeconds();
+    Vector leaderPos = m_leader->GetPosition();
+    for (int64_t k = 1; k <= steps; ++k) {
+        double f = static_cast<double>(k) / steps;
+        Vector target = m_lastLeaderPos + (leaderPos - m_lastLeaderPos) * f;
+        Vector direction = target - m_position;
+        m_velocity = Normalize(direction) * m_speed + Vector(m_noise->GetValue(-m_noiseFactor, m_noiseFactor), m_noise->GetValue(-m_noiseFactor, m_noiseFactor), 0);
+        m_position = m_position + m_velocity * dt; // Simple Euler integration
+    }
+    m_lastLeaderPos = leaderPos;
+    m_lastUpdate = m_lastUpdate + TimeStep(steps * m_step.GetTimeStep());
+}
+
+Vector PursuitFollowerMobilityModel::DoGetPosition() const {
+    Update();
+    return m_position;
+}
+
+void PursuitFollowerMobilityModel::DoSetPosition(const Vector& position) {
+    Update();
+    m_position = position;
+    NotifyCourseChange();
+}
+
+Vector PursuitFollowerMobilityModel::DoGetVelocity() const {
+    Update();
+    return m_velocity;
+}
+
+int64_t PursuitFollowerMobilityModel::DoAssignStreams(int64_t stream) {
+    m_noise->SetStream(stream);
+    return 1;
+}
+
+NS_OBJECT_ENSURE_REGISTERED(SilentPositionMobilityModel);
+
+TypeId SilentPositionMobilityModel::GetTypeId() {
+    static TypeId tid = TypeId("SilentPositionMobilityModel")
+        .SetParent<MobilityModel>()
+        .SetGroupName("Mobility")
+        .AddConstructor<SilentPositionMobilityModel>();
+    return tid;
+}
+
+SilentPositionMobilityModel::SilentPositionMobilityModel() : m_position(0, 0, 0) {
+}
+
+Vector SilentPositionMobilityModel::DoGetPosition() const {
+    return m_position;
+}
+
+void SilentPositionMobilityModel::DoSetPosition(const Vector& position) {
+    m_position = position; // No NotifyCourseChange(), see the class comment
+}
+
+Vector SilentPositionMobilityModel::DoGetVelocity() const {
+    return Vector(0, 0, 0);
+}
+
+//================================================================================
+// 8. SPATIAL-GRID SPECTRUM CHANNEL
+//================================================================================
+
+NS_OBJECT_ENSURE_REGISTERED(GridSpectrumChannel);
+
+TypeId GridSpectrumChannel::GetTypeId() {
+    static TypeId tid = TypeId("GridSpectrumChannel")
+        .SetParent<SpectrumChannel>()
+        .SetGroupName("Spectrum")
+        .AddConstructor<GridSpectrumChannel>()
+        .AddAttribute("MaxTxPowerDbm", "Highest transmit power used by any attached PHY.",
+                      DoubleValue(16.0206),
+                      MakeDoubleAccessor(&GridSpectrumChannel::m_maxTxPowerDbm),
+                      MakeDoubleChecker<double>())
+        .AddAttribute("RxThresholdDbm", "Received power below which a signal is not delivered (the PHY RxSensitivity).",
+                      DoubleValue(-101.0),
+                      MakeDoubleAccessor(&GridSpectrumChannel::m_rxThresholdDbm),
+                      MakeDoubleChecker<double>())
+        .AddAttribute("MaxRange", "Delivery range in m; 0 derives it from the link budget.",
+                      DoubleValue(0.0),
+                      MakeDoubleAccessor(&GridSpectrumChannel::m_maxRange),
+                      MakeDoubleChecker<double>(0.0))
+        .AddAttribute("MaxNodeSpeed", "Upper bound on node speed in m/s, used to widen cells between re-binnings.",
+                      DoubleValue(20.0),
+                      MakeDoubleAccessor(&GridSpectrumChannel::m_maxNodeSpeed),
+                      MakeDoubleChecker<double>(0.0))
+        .AddAttribute("RebinInterval", "Interval at which all receivers are re-binned from their current positions.",
+                      TimeValue(Seconds(1.0)),
+                      MakeTimeAccessor(&GridSpectrumChannel::m_rebinInterval),
+                      MakeTimeChecker());
+    return tid;
+}
+
+GridSpectrumChannel::GridSpectrumChannel()
+    : m_maxTxPowerDbm(16.0206),
+      m_rxThresholdDbm(-101.0),
+      m_maxRange(0.0),
+      m_range(0.0),
+      m_cellSize(0.0),
+      m_maxNodeSpeed(20.0),
+      m_rebinInterval(Seconds(1.0)),
+      m_lastRebin(Seconds(0.0)),
+      m_transmissions(0),
+      m_evaluatedReceivers(0),
+      m_prunedReceivers(0) {
+}
+
+void GridSpectrumChannel::DoDispose() {
+    for (auto& entry : m_byMobility) {
+        m_receivers[entry.second.front()].mobility->TraceDisconnectWithoutContext("CourseChange", MakeCallback(&GridSpectrumChannel::CourseChanged, this));
+    }
+    m_receivers.clear();
+    m_cells.clear();
+    m_byMobility.clear();
+    m_spectrumModel = nullptr;
+    SpectrumChannel::DoDispose();
+}
+
+/**
+ * @brief Returns the delivery range in m, deriving it from the link budget on first use.
+ */
+double GridSpectrumChannel::GetRange() {
+    if (m_range <= 0) {
+        ComputeGeometry();
+    }
+    return m_range;
+}
+
+uint64_t GridSpectrumChannel::GetTransmissions() const {
+    return m_transmissions;
+}
+
+uint64_t GridSpectrumChannel::GetEvaluatedReceivers() const {
+    return m_evaluatedReceivers;
+}
+
+uint64_t GridSpectrumChannel::GetPrunedReceivers() const {
+    return m_prunedReceivers;
+}
+
+/**
+ * @brief Computes the delivery range and the cell size.
+ */
+void GridSpectrumChannel::ComputeGeometry() {
+    m_range = m_maxRange;
+    if (m_range <= 0) {
+        NS_ABORT_MSG_IF(!m_propagationLoss, "GridSpectrumChannel needs a propagation loss model or MaxRange");
+        Ptr<ConstantPositionMobilityModel> a = CreateObject<ConstantPositionMobilityModel>();
+        Ptr<ConstantPositionMobilityModel> b = CreateObject<ConstantPositionMobilityModel>();
+        a->SetPosition(Vector(0, 0, 0));
+        double low = 0.0;
+        double high = 1.0;
+        // Grow the bracket until the signal is below the threshold, then bisect
+        for (b->SetPosition(Vector(high, 0, 0)); m_propagationLoss->CalcRxPower(m_maxTxPowerDbm, a, b) >= m_rxThresholdDbm; b->SetPosition(Vector(high, 0, 0))) {
+            low = high;
+            high *= 2.0;
+            NS_ABORT_MSG_IF(high > 1e7, "Propagation loss never drops below RxThresholdDbm; set MaxRange");
+        }
+        while (high - low > 0.01) {
+            double mid = 0.5 * (low + high);
+            b->SetPosition(Vector(mid, 0, 0));
+            if (m_propagationLoss->CalcRxPower(m_maxTxPowerDbm, a, b) >= m_rxThresholdDbm) {
+                low = mid;
+            } else {
+                high = mid;
+            }
+        }
+        m_range = high;
+    }
+    m_cellSize = m_range + m_maxNodeSpeed * m_rebinInterval.GetSeconds();
+}
+
+int64_t GridSpectrumChannel::CellKey(int64_t ix, int64_t iy) const {
+    // Shifted as unsigned: left-shifting a negative index is undefined before C++20
+    return static_cast<int64_t>((static_cast<uint64_t>(ix) << 32) ^ (static_cast<uint64_t>(iy) & 0xffffffffULL));
+}
+
+int64_t GridSpectrumChannel::CellOf(const Vector& position) const {
+    return CellKey(static_cast<int64_t>(std::floor(position.x / m_cellSize)),
+                   static_cast<int64_t>(std::floor(position.y / m_cellSize)));
+}
+
+/**
+ * @brief Moves receiver `index` to the cell of its current position.
+ */
+void GridSpectrumChannel::Bin(uint32_t index) {
+    Receiver& receiver = m_receivers[index];
+    int64_t cell = CellOf(receiver.mobility->GetPosition());
+    if (cell == receiver.cell) {
+        return;
+    }
+    if (receiver.cell != std::numeric_limits<int64_t>::min()) {
+        std::vector<uint32_t>& members = m_cells[receiver.cell];
+        members.erase(std::find(members.begin(), members.end(), index));
+    }
+    m_cells[cell].push_back(index);
+    receiver.cell = cell;
+}
+
+void GridSpectrumChannel::RebinAll() {
+    for (uint32_t i = 0; i < m_receivers.size(); ++i) {
+        Bin(i);
+    }
+    m_lastRebin = Simulator::Now();
+}
+
+void GridSpectrumChannel::CourseChanged(Ptr<const MobilityModel> mobility) {
+    auto it = m_byMobility.find(PeekPointer(mobility));
+    if (it == m_byMobility.end()) {
+        return;
+    }
+    for (uint32_t index : it->second) {
+        Bin(index);
+    }
+}
+
+void GridSpectrumChannel::AddRx(Ptr<SpectrumPhy> phy) {
+    if (m_range <= 0) {
+        ComputeGeometry();
+    }
+    Ptr<MobilityModel> mobility = phy->GetMobility();
+    NS_ABORT_MSG_IF(!mobility, "GridSpectrumChannel needs PHYs with a mobility model (install mobility before the devices)");
+
+    uint32_t index = m_receivers.size();
+    m_receivers.push_back({phy, mobility, std::numeric_limits<int64_t>::min()});
+    std::vector<uint32_t>& sameMobility = m_byMobility[PeekPointer(mobility)];
+    if (sameMobility.empty()) {
+        mobility->TraceConnectWithoutContext("CourseChange", MakeCallback(&GridSpectrumChannel::CourseChanged, this));
+    }
+    sameMobility.push_back(index);
+    Bin(index);
+}
+
+void GridSpectrumChannel::RemoveRx(Ptr<SpectrumPhy> phy) {
+    auto it = std::find_if(m_receivers.begin(), m_receivers.end(), [&phy](const Receiver& r) { return r.phy == phy; });
+    if (it == m_receivers.end()) {
+        return;
+    }
+    // Rare (only on teardown), so rebuild the indices from scratch
+    std::vector<Receiver> receivers;
+    for (const Receiver& r : m_receivers) {
+        if (r.phy != phy) {
+            receivers.push_back(r);
+        }
+    }
+    for (auto& entry : m_byMobility) {
+        m_receivers[entry.second.front()].mobility->TraceDisconnectWithoutContext("CourseChange", MakeCallback(&GridSpectrumChannel::CourseChanged, this));
+    }
+    m_receivers.clear();
+    m_cells.clear();
+    m_byMobility.clear();
+    for (const Receiver& r : receivers) {
+        AddRx(r.phy);
+    }
+}
+
+std::size_t GridSpectrumChannel::GetNDevices() const {
+    return m_receivers.size();
+}
+
+Ptr<NetDevice> GridSpectrumChannel::GetDevice(std::size_t i) const {
+    return m_receivers.at(i).phy->GetDevice()->GetObject<NetDevice>();
+}
+
+void GridSpectrumChannel::StartRx(Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver) {
+    receiver->StartRx(params);
+}
+
+/**
+ * @brief Delivers a transmission to the receivers within range of the sender.
+ *
+ * Same per-receiver processing as SingleModelSpectrumChannel::StartTx()
+ * (antenna gains, loss chain, MaxLossDb, spectrum loss, delay and traces),
+ * applied only to receivers found in the cells around the sender.
+ */
+void GridSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams) {
+    NS_ASSERT_MSG(txParams->psd, "NULL txPsd");
+    NS_ASSERT_MSG(txParams->txPhy, "NULL txPhy");
+    m_txSigParamsTrace(txParams->Copy());
+
+    if (!m_spectrumModel) {
+        m_spectrumModel = txParams->psd->GetSpectrumModel();
+    } else {
+        NS_ASSERT(*(txParams->psd->GetSpectrumModel()) == *m_spectrumModel);
+    }
+
+    if (Simulator::Now() - m_lastRebin >= m_rebinInterval) {
+        RebinAll();
+    }
+    ++m_transmissions;
+
+    Ptr<MobilityModel> senderMobility = txParams->txPhy->GetMobility();
+    Vector senderPos = senderMobility->GetPosition();
+    Ptr<NetDevice> txNetDevice = txParams->txPhy->GetDevice();
+    int64_t cx = static_cast<int64_t>(std::floor(senderPos.x / m_cellSize));
+    int64_t cy = static_cast<int64_t>(std::floor(senderPos.y / m_cellSize));
+
+    for (int64_t ix = cx - 1; ix <= cx + 1; ++ix) {
+        for (int64_t iy = cy - 1; iy <= cy + 1; ++iy) {
+            auto cell = m_cells.find(CellKey(ix, iy));
+            if (cell == m_cells.end()) {
+                continue;
+            }
+            for (uint32_t index : cell->second) {
+                const Receiver& receiver = m_receivers[index];
+                if (receiver.phy == txParams->txPhy) {
+                    continue;
+                }
+                Ptr<NetDevice> rxNetDevice = receiver.phy->GetDevice();
+                if (rxNetDevice && txNetDevice && rxNetDevice->GetNode()->GetId() == txNetDevice->GetNode()->GetId()) {
+                    continue; // Antennas of the same node, as in SingleModelSpectrumChannel
+                }
+                Vector receiverPos = receiver.mobility->GetPosition();
+                if (CalculateDistance(senderPos, receiverPos) > m_range) {
+                    ++m_prunedReceivers;
+                    continue;
+                }
+                ++m_evaluatedReceivers;
+
+                Ptr<SpectrumSignalParameters> rxParams = txParams->Copy();
+                double txAntennaGain = 0;
+                double rxAntennaGain = 0;
+                double propagationGainDb = 0;
+                double pathLossDb = 0;
+                if (rxParams->txAntenna) {
+                    Angles txAngles(receiverPos, senderPos);
+                    txAntennaGain = rxParams->txAntenna->GetGainDb(txAngles);
+                    pathLossDb -= txAntennaGain;
+                }
+                Ptr<AntennaModel> rxAntenna = DynamicCast<AntennaModel>(receiver.phy->GetAntenna());
+                if (rxAntenna) {
+                    Angles rxAngles(senderPos, receiverPos);
+                    rxAntennaGain = rxAntenna->GetGainDb(rxAngles);
+                    pathLossDb -= rxAntennaGain;
+                }
+                if (m_propagationLoss) {
+                    propagationGainDb = m_propagationLoss->CalcRxPower(0, senderMobility, receiver.mobility);
+                    pathLossDb -= propagationGainDb;
+                }
+                m_gainTrace(senderMobility, receiver.mobility, txAntennaGain, rxAntennaGain, propagationGainDb, pathLossDb);
+                m_pathLossTrace(txParams->txPhy, receiver.phy, pathLossDb);
+                if (pathLossDb > m_maxLossDb) {
+                    continue;
+                }
+                *(rxParams->psd) *= std::pow(10.0, (-pathLossDb) / 10.0);
+                if (m_spectrumPropagationLoss) {
+                    rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity(rxParams, senderMobility, receiver.mobility);
+                }
+                Time delay = m_propagationDelay ? m_propagationDelay->GetDelay(senderMobility, receiver.mobility) : MicroSeconds(0);
+
+                if (rxNetDevice) {
+                    Simulator::ScheduleWithContext(rxNetDevice->GetNode()->GetId(), delay, &GridSpectrumChannel::StartRx, rxParams, receiver.phy);
+                } else {
+                    Simulator::Schedule(delay, &GridSpectrumChannel::StartRx, rxParams, receiver.phy);
+                }
+            }
+        }
+    }
+}
+
+//================================================================================
+// 9. PROPAGATION LOSS CACHE
+//================================================================================
+
+NS_OBJECT_ENSURE_REGISTERED(CachedPropagationLossModel);
+
+TypeId CachedPropagationLossModel::GetTypeId() {
+    static TypeId tid = TypeId("CachedPropagationLossModel")
+        .SetParent<PropagationLossModel>()
+        .SetGroupName("Propagation")
+        .AddConstructor<CachedPropagationLossModel>()
+        .AddAttribute("MaxEntries", "Number of cached pairs after which the table is cleared.",
+                      UintegerValue(1u << 20),
+                      MakeUintegerAccessor(&CachedPropagationLossModel::m_maxEntries),
+                      MakeUintegerChecker<uint32_t>(1));
+    return tid;
+}
+
+CachedPropagationLossModel::CachedPropagationLossModel()
+    : m_maxEntries(1u << 20),
+      m_hits(0),
+      m_misses(0) {
+}
+
+void CachedPropagationLossModel::DoDispose() {
+    m_inner = nullptr;
+    m_cache.clear();
+    PropagationLossModel::DoDispose();
+}
+
+/**
+ * @brief Sets the loss chain whose results are cached.
+ */
+void CachedPropagationLossModel::SetInner(Ptr<PropagationLossModel> inner) {
+    m_inner = inner;
+    m_cache.clear();
+}
+
+uint64_t CachedPropagationLossModel::GetHits() const {
+    return m_hits;
+}
+
+uint64_t CachedPropagationLossModel::GetMisses() const {
+    return m_misses;
+}
+
+std::size_t CachedPropagationLossModel::PairKeyHash::operator()(const PairKey& key) const {
+    std::size_t h = std::hash<const void*>()(key.tx);
+    return h ^ (std::hash<const void*>()(key.rx) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+}
+
+double CachedPropagationLossModel::DoCalcRxPower(double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const {
+    Vector txPosition = a->GetPosition();
+    Vector rxPosition = b->GetPosition();
+    Entry& entry = m_cache[PairKey{PeekPointer(a), PeekPointer(b)}];
+    if (entry.valid && entry.txPosition.x == txPosition.x && entry.txPosition.y == txPosition.y
+        && entry.txPosition.z == txPosition.z && entry.rxPosition.x == rxPosition.x
+        && entry.rxPosition.y == rxPosition.y && entry.rxPosition.z == rxPosition.z) {
+        ++m_hits;
+        return txPowerDbm + entry.gainDb;
+    }
+    ++m_misses;
+    entry.txPosition = txPosition;
+    entry.rxPosition = rxPosition;
+    entry.gainDb = m_inner->CalcRxPower(0.0, a, b);
+    entry.valid = true;
+    double gainDb = entry.gainDb;
+    if (m_cache.size() > m_maxEntries) {
+        m_cache.clear();
+    }
+    return txPowerDbm + gainDb;
+}
+
+int64_t CachedPropagationLossModel::DoAssignStreams(int64_t stream) {
+    return m_inner ? m_inner->AssignStreams(stream) : 0;
+}
+
+//================================================================================
+// 10. PARAMETER SWEEP & PARALLEL EXECUTION
+//================================================================================
+
+/**
+ * @brief Parses a sweep specification: a value, a list "a,b,c" or a range "start:stop[:step]".
+ *
+ * Ranges are inclusive of `stop` (within a small tolerance for floating point
+ * steps) and the step defaults to 1.
+ */
+std::vector<double> ParseSweepValues(const std::string& spec, const std::string& name) {
+    std::vector<double> values;
+    std::stringstream list(spec);
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        std::vector<double> fields;
+        std::stringstream range(item);
+        std::string field;
+        while (std::getline(range, field, ':')) {
+            char* end = nullptr;
+            double value = std::strtod(field.c_str(), &end);
+            NS_ABORT_MSG_IF(field.empty() || *end != '\0', "Invalid value '" << field << "' in --" << name << "=" << spec);
+            fields.push_back(value);
+        }
+        NS_ABORT_MSG_IF(fields.empty() || fields.size() > 3, "Invalid item '" << item << "' in --" << name << "=" << spec);
+
+        if (fields.size() == 1) {
+            values.push_back(fields[0]);
+            continue;
+        }
+        double start = fields[0];
+        double stop = fields[1];
+        double step = (fields.size() == 3) ? fields[2] : 1.0;
+        NS_ABORT_MSG_IF(step <= 0 || stop < start, "Invalid range '" << item << "' in --" << name);
+        for (uint32_t k = 0; start + k * step <= stop + step * 1e-9; ++k) {
+            values.push_back(start + k * step);
+        }
+    }
+    NS_ABORT_MSG_IF(values.empty(), "No values given for --" << name);
+    return values;
+}
+
+/**
+ * @brief Same as ParseSweepValues() for integral parameters.
+ */
+std::vector<uint32_t> ParseSweepIntegers(const std::string& spec, const std::string& name) {
+    std::vector<uint32_t> values;
+    for (double value : ParseSweepValues(spec, name)) {
+        NS_ABORT_MSG_IF(value < 0 || value != std::floor(value), "--" << name << " expects integers, got " << value);
+        values.push_back(static_cast<uint32_t>(value));
+    }
+    return values;
+}
+
+/**
+ * @brief Expands the Cartesian product of the swept parameters into sweep points.
+ */
+std::vector<SimulationConfig> ExpandSweepGrid(const SimulationConfig& base, const std::vector<uint32_t>& nodesPerClusterValues, const std::vector<double>& followerSpeedValues, const std::vector<double>& noiseFactorValues, const std::vector<uint32_t>& packetSizeValues, const std::vector<double>& followerRateValues) {
+    std::vector<SimulationConfig> points;
+    for (double followerRate : followerRateValues) {
+        NS_ABORT_MSG_IF(followerRate <= 0, "followerRate must be positive");
+        for (uint32_t packetSizei : packetSizeValues) {
+            // Telemetry packets carry a SeqTsSizeHeader, which must fit in the payload
+            NS_ABORT_MSG_IF(packetSizei < SeqTsSizeHeader().GetSerializedSize(),
+                            "packetSize must be at least " << SeqTsSizeHeader().GetSerializedSize() << " bytes (SeqTsSizeHeader)");
+            for (uint32_t nodesPerCluster : nodesPerClusterValues) {
+                NS_ABORT_MSG_IF(nodesPerCluster < 2, "nodesPerCluster must be at least 2 (leader + one follower)");
+                for (double followerSpeed : followerSpeedValues) {
+                    for (double noiseFactor : noiseFactorValues) {
+                        SimulationConfig point = base;
+                        point.nodesPerCluster = nodesPerCluster;
+                        point.followerSpeed = followerSpeed;
+                        point.noiseFactor = noiseFactor;
+                        point.packetSizei = packetSizei;
+                        point.followerRate = followerRate;
+                        points.push_back(point);
+                    }
+                }
+            }
+        }
+    }
+    return points;
+}
+
+/**
+ * @brief Rough relative cost of one run, used only to order the work queue.
+ *
+ * With one shared channel every frame is processed by every node: cost grows
+ * with (total nodes) x (followers) x (packets per second) x simTime. The split
+ * plan only reaches the sender's subnet, roughly dividing by the subnet count.
+ */
+double EstimateTaskCost(const SimulationConfig& config) {
+    double followers = static_cast<double>(CountClusters(config)) * (config.nodesPerCluster - 1);
+    double totalNodes = followers + CountLeaders(config);
+    double packetsPerSecond = config.followerRate * 1000.0 / (8.0 * config.packetSizei);
+    double cost = totalNodes * followers * packetsPerSecond * config.simulationTime;
+    if (config.channelPlan == "split") {
+        cost /= CountClusters(config) + 1;
+    }
+    return cost;
+}
+
+/**
+ * @brief Runs one replication with its seed, appending its rows to the output files + `fileSuffix`.
+ *
+ * The stream index counter is reset so the random streams of a run depend only
+ * on its parameters and run number, not on what the process ran before.
+ */
+RunSummary RunTask(const SimulationTask& task, const std::string& fileSuffix) {
+    RngSeedManager::SetRun(task.runNumber); // Set a unique random seed for each run
+    RngSeedManager::ResetNextStreamIndex();
+    std::cout << "Running simulation " << task.runNumber << "/" << task.numRuns << " for packet size: " << task.config.packetSizei << std::endl;
+    return RunSimulation(task.config, task.runNumber, fileSuffix);
+}
+
+/**
+ * @brief Runs all tasks, sequentially or on a pool of `jobs` worker processes.
+ *
+ * Workers are forked once and pull task indices from a counter in shared
+ * memory until the queue is empty, so no process is started per run and
+ * every worker stays busy until the last task. The queue is ordered by
+ * estimated cost, longest first, so large clusters do not end up as a tail
+ * on a single core. Each task writes to a private part file; the part files
+ * are merged into the results (and windows) files in sweep order at the end.
+ * The per-run summaries travel back to the parent through the same shared
+ * mapping and are stored in each task.
+ */
+void ExecuteTasks(std::vector<SimulationTask>& tasks, uint32_t jobs) {
+    if (!tasks.empty() && tasks.front().config.warmStart > 0) {
+        ExecuteWarmStarted(tasks, jobs);
+        return;
+    }
+    if (jobs <= 1 || tasks.size() <= 1) {
+        for (SimulationTask& task : tasks) {
+            task.summary = RunTask(task, "");
+        }
+        return;
+    }
+
+    // --- Work Queue (longest first) ---
+    std::vector<uint32_t> order(tasks.size());
+    for (uint32_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&tasks](uint32_t a, uint32_t b) {
+        return tasks[a].estimatedCost > tasks[b].estimatedCost;
+    });
+
+    // Layout: one RunSummary per task, then the queue counter.
+    size_t sharedSize = tasks.size() * sizeof(RunSummary) + sizeof(std::atomic<uint32_t>);
+    void* shared = mmap(nullptr, sharedSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    NS_ABORT_MSG_IF(shared == MAP_FAILED, "mmap() failed for the shared work queue");
+    RunSummary* summaries = static_cast<RunSummary*>(shared);
+    std::atomic<uint32_t>* nextTask = new (summaries + tasks.size()) std::atomic<uint32_t>(0);
+
+    // --- Worker Pool ---
+    uint32_t numWorkers = std::min<uint32_t>(jobs, tasks.size());
+    std::vector<pid_t> workers;
+    for (uint32_t w = 0; w < numWorkers; ++w) {
+        std::cout.flush(); // Do not let the child inherit buffered output
+        pid_t pid = fork();
+        NS_ABORT_MSG_IF(pid < 0, "fork() failed while starting worker " << w);
+        if (pid == 0) {
+            for (uint32_t i = nextTask->fetch_add(1); i < order.size(); i = nextTask->fetch_add(1)) {
+                const SimulationTask& task = tasks[order[i]];
+                summaries[order[i]] = RunTask(task, TaskPartSuffix(order[i]));
+            }
+            std::cout.flush();
+            _exit(0);
+        }
+        workers.push_back(pid);
+    }
+
+    uint32_t failedWorkers = 0;
+    for (pid_t pid : workers) {
+        int status = 0;
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+        }
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            std::cerr << "Worker " << pid << " failed" << std::endl;
+            ++failedWorkers;
+        }
+    }
+    for (uint32_t i = 0; i < tasks.size(); ++i) {
+        tasks[i].summary = summaries[i];
+    }
+    munmap(shared, sharedSize);
+
+    MergeTaskPartFiles(tasks);
+    NS_ABORT_MSG_IF(failedWorkers > 0, failedWorkers << " of " << numWorkers << " workers failed");
+}
+
+/**
+ * @brief Runs every task in a fresh child process, up to `jobs` at a time (benchmarks).
+ *
+ * Unlike the worker pool, no process runs two tasks, so the peak RSS of a
+ * run does not include pages kept from an earlier one and does not depend on
+ * the task order. Summaries come back through shared memory and the part
+ * files are merged in task order, as in ExecuteTasks.
+ */
+void ExecuteTasksIsolated(std::vector<SimulationTask>& tasks, uint32_t jobs) {
+    size_t sharedSize = tasks.size() * sizeof(RunSummary);
+    void* shared = mmap(nullptr, sharedSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    NS_ABORT_MSG_IF(shared == MAP_FAILED, "mmap() failed for the benchmark summaries");
+    RunSummary* summaries = static_cast<RunSummary*>(shared);
+    for (uint32_t i = 0; i < tasks.size(); ++i) {
+        summaries[i] = RunSummary();
+    }
+
+    uint32_t failedRuns = 0;
+    auto waitForChild = [&failedRuns]() {
+        int status = 0;
+        pid_t pid;
+        while ((pid = wait(&status)) < 0 && errno == EINTR) {
+        }
+        if (pid < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            ++failedRuns;
+        }
+    };
+    uint32_t running = 0;
+    for (uint32_t i = 0; i < tasks.size(); ++i) {
+        if (running >= std::max<uint32_t>(jobs, 1)) {
+            waitForChild();
+            --running;
+        }
+        std::cout.flush(); // Do not let the child inherit buffered output
+        pid_t pid = fork();
+        NS_ABORT_MSG_IF(pid < 0, "fork() failed for benchmark run " << i);
+        if (pid == 0) {
+            summaries[i] = RunTask(tasks[i], TaskPartSuffix(i));
+            std::cout.flush();
+            _exit(0);
+        }
+        ++running;
+    }
+    while (running > 0) {
+        waitForChild();
+        --running;
+    }
+    for (uint32_t i = 0; i < tasks.size(); ++i) {
+        tasks[i].summary = summaries[i];
+    }
+    munmap(shared, sharedSize);
+
+    MergeTaskPartFiles(tasks);
+    NS_ABORT_MSG_IF(failedRuns > 0, failedRuns << " of " << tasks.size() << " benchmark runs failed");
+}
+
+/**
+ * @brief Runs the tasks in warm-start mode: one warm-up per scenario, one child per task.
+ *
+ * Tasks with the same run number whose configurations differ only in
+ * packet size and offered rate form a group. The group is built and run to
+ * config.warmStart once, with that run number; the state is then forked,
+ * copy-on-write, into one child per task, up to `jobs` at a time. Each
+ * replication gets its own warm-up, so replications stay independent.
+ * Children write part files like workers do, so the outputs are merged in
+ * sweep order. Groups run one after the other.
+ */
+void ExecuteWarmStarted(std::vector<SimulationTask>& tasks, uint32_t jobs) {
+    // --- Groups of tasks sharing a warm-up ---
+    std::vector<std::string> keys;
+    std::vector<WarmStartGroup> groups;
+    for (uint32_t i = 0; i < tasks.size(); ++i) {
+        SimulationConfig shared = tasks[i].config;
+        shared.packetSizei = 0;
+        shared.followerRate = 0.0;
+        std::string key = ConfigJson(shared) + "#" + std::to_string(tasks[i].runNumber);
+        uint32_t g = std::find(keys.begin(), keys.end(), key) - keys.begin();
+        if (g == keys.size()) {
+            keys.push_back(key);
+            groups.push_back({&tasks, std::vector<uint32_t>(), nullptr, jobs});
+        }
+        groups[g].variants.push_back(i);
+    }
+
+    size_t sharedSize = tasks.size() * sizeof(RunSummary);
+    void* shared = mmap(nullptr, sharedSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    NS_ABORT_MSG_IF(shared == MAP_FAILED, "mmap() failed for the warm-start summaries");
+    RunSummary* summaries = static_cast<RunSummary*>(shared);
+    for (uint32_t i = 0; i < tasks.size(); ++i) {
+        summaries[i] = RunSummary();
+    }
+
+    std::cout << "Warm start at " << tasks.front().config.warmStart << " s: " << tasks.size() << " runs from "
+              << groups.size() << " warm-ups" << std::endl;
+    for (WarmStartGroup& group : groups) {
+        group.summaries = summaries;
+        const SimulationTask& first = tasks[group.variants.front()];
+        RngSeedManager::SetRun(first.runNumber);
+        RngSeedManager::ResetNextStreamIndex();
+        RunSimulation(first.config, first.runNumber, "", &group);
+    }
+
+    for (uint32_t i = 0; i < tasks.size(); ++i) {
+        tasks[i].summary = summaries[i];
+    }
+    munmap(shared, sharedSize);
+    MergeTaskPartFiles(tasks);
+}
+
+/**
+ * @brief Suffix of the temporary files a worker writes the rows of one task to.
+ */
+std::string TaskPartSuffix(uint32_t taskIndex) {
+    std::stringstream ss;
+    ss << ".task" << taskIndex << ".part";
+    return ss.str();
+}
+
+/**
+ * @brief Appends the per-task part files to the output files in sweep order and removes them.
+ */
+void MergeTaskPartFiles(const std::vector<SimulationTask>& tasks) {
+    for (uint32_t i = 0; i < tasks.size(); ++i) {
+        const SimulationConfig& config = tasks[i].config;
+        MergeResultsPartFile(config.resultsFile, config.resultsFile + TaskPartSuffix(i));
+        if (config.window > 0) {
+            MergeResultsPartFile(config.windowsFile, config.windowsFile + TaskPartSuffix(i));
+        }
+        MergeResultsPartFile(config.nodesFile, config.nodesFile + TaskPartSuffix(i));
+        MergeTextPartFile(config.manifestFile, config.manifestFile + TaskPartSuffix(i));
+    }
+    std::cout << "Merged " << tasks.size() << " runs into the results files" << std::endl;
+}
+
+/**
+ * @brief Appends the blocks of one part file to `resultsFileName` and removes the part file.
+ *
+ * Part files use the same block format, so merging copies whole blocks and
+ * the result is identical to the file written by sequential runs.
+ */
+void MergeResultsPartFile(const std::string& resultsFileName, const std::string& partFileName) {
+    std::string error;
+    {
+        ResultsFileReader partFile;
+        if (!partFile.Open(partFileName, &error)) {
+            return; // The worker failed before writing statistics for this task
+        }
+        ResultsAppender appender;
+        NS_ABORT_MSG_IF(!appender.Open(resultsFileName, partFile.GetSchema(), &error), error);
+        ResultsBlock block(partFile.GetSchema());
+        while (partFile.NextBlock(&block)) {
+            NS_ABORT_MSG_IF(!appender.Append(block, &error), error);
+        }
+    }
+    std::remove(partFileName.c_str());
+}
+
+/**
+ * @brief Appends a text part file to `fileName` and removes the part file.
+ */
+void MergeTextPartFile(const std::string& fileName, const std::string& partFileName) {
+    std::ifstream partFile(partFileName, std::ios_base::binary);
+    if (!partFile.good()) {
+        return;
+    }
+    std::ofstream outFile(fileName, std::ios_base::app | std::ios_base::binary);
+    outFile << partFile.rdbuf();
+    partFile.close();
+    std::remove(partFileName.c_str());
+}
+
+//================================================================================
+// 11. SEQUENTIAL STOPPING RULE
+//================================================================================
+
+/**
+ * @brief Student-t 95% confidence half-width of the mean of `samples`.
+ *
+ * @param samples Per-run values of one metric (at least two).
+ * @param mean Receives the sample mean.
+ */
+double ConfidenceHalfWidth(const std::vector<double>& samples, double* mean) {
+    // Two-sided 97.5% quantiles of Student's t for 1..30 degrees of freedom
+    static const double tQuantile[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                       2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                       2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    size_t n = samples.size();
+    double sum = 0.0;
+    for (double v : samples) {
+        sum += v;
+    }
+    *mean = sum / n;
+    if (n < 2) {
+        return std::numeric_limits<double>::infinity();
+    }
+    double squares = 0.0;
+    for (double v : samples) {
+        squares += (v - *mean) * (v - *mean);
+    }
+    double stdDev = std::sqrt(squares / (n - 1));
+    double t = (n - 1 <= 30) ? tQuantile[n - 2] : 1.960;
+    return t * stdDev / std::sqrt(static_cast<double>(n));
+}
+
+/**
+ * @brief Replicates every sweep point until its confidence intervals are tight enough.
+ *
+ * Each point starts with minRuns replications. After every round, a point is
+ * done when the 95% CI half-width of the per-run means of PDR, AvgLatency_ms
+ * and AvgThroughput_kbps is at most ciTarget times the mean (or it reached
+ * maxRuns). Unfinished points get another batch, sized so that the worker
+ * pool stays busy; with jobs=1 each point gets exactly the runs it needs.
+ * Runs keep their usual run numbers and seeds, so run k of a point is the
+ * same whether it was scheduled in the first round or a later one.
+ *
+ * The per-point outcome, including the number of runs used, is appended to
+ * hierarchical_manet_convergence.csv.
+ */
+void RunUntilConverged(const std::vector<SimulationConfig>& points, uint32_t jobs, double ciTarget, uint32_t minRuns, uint32_t maxRuns) {
+    minRuns = std::max<uint32_t>(minRuns, 2);
+    maxRuns = std::max(maxRuns, minRuns);
+
+    std::vector<std::vector<RunSummary>> results(points.size());
+    std::vector<bool> converged(points.size(), false);
+    std::vector<bool> done(points.size(), false);
+    std::vector<uint32_t> batch(points.size(), minRuns);
+
+    // Per-run samples of the three stopping metrics of a point
+    auto metricSamples = [&results](uint32_t p) {
+        std::vector<std::vector<double>> samples(3);
+        for (const RunSummary& r : results[p]) {
+            samples[0].push_back(r.pdr);
+            samples[1].push_back(r.avgLatency);
+            samples[2].push_back(r.avgThroughput);
+        }
+        return samples;
+    };
+
+    for (uint32_t round = 1;; ++round) {
+        // --- Schedule the next batch of every unfinished point ---
+        std::vector<SimulationTask> tasks;
+        std::vector<uint32_t> taskPoint;
+        for (uint32_t p = 0; p < points.size(); ++p) {
+            if (done[p]) {
+                continue;
+            }
+            uint32_t firstRun = results[p].size() + 1;
+            uint32_t lastRun = std::min<uint32_t>(firstRun + batch[p] - 1, maxRuns);
+            for (uint32_t run = firstRun; run <= lastRun; ++run) {
+                tasks.push_back({points[p], run, maxRuns, EstimateTaskCost(points[p]), RunSummary()});
+                taskPoint.push_back(p);
+            }
+        }
+        if (tasks.empty()) {
+            break;
+        }
+        std::cout << "Stopping rule round " << round << ": " << tasks.size() << " runs" << std::endl;
+        ExecuteTasks(tasks, jobs);
+
+        for (uint32_t i = 0; i < tasks.size(); ++i) {
+            NS_ABORT_MSG_IF(!tasks[i].summary.valid, "Run " << tasks[i].runNumber << " did not complete");
+            results[taskPoint[i]].push_back(tasks[i].summary);
+        }
+
+        // --- Check the stopping rule ---
+        uint32_t pending = 0;
+        for (uint32_t p = 0; p < points.size(); ++p) {
+            if (done[p]) {
+                continue;
+            }
+            converged[p] = true;
+            for (const std::vector<double>& samples : metricSamples(p)) {
+                double mean = 0.0;
+                double halfWidth = ConfidenceHalfWidth(samples, &mean);
+                converged[p] = converged[p] && (halfWidth <= ciTarget * std::fabs(mean));
+            }
+            done[p] = converged[p] || results[p].size() >= maxRuns;
+            pending += done[p] ? 0 : 1;
+        }
+        for (uint32_t p = 0; p < points.size(); ++p) {
+            batch[p] = std::max<uint32_t>(1, (jobs + pending - 1) / std::max<uint32_t>(pending, 1));
+        }
+    }
+
+    // --- Convergence Report ---
+    std::string reportFileName = "hierarchical_manet_convergence.csv";
+    std::ifstream testFile(reportFileName);
+    bool fileExists = testFile.good();
+    testFile.close();
+
+    std::ofstream outFile(reportFileName, std::ios_base::app);
+    if (!fileExists) {
+        outFile << "NodesPerCluster,SimTime,AreaSize,FollowerSpeed,NoiseFactor,PacketSize,OfferedRate_kbps,"
+                << "ClusterFanout,Channel,ChannelPlan,Mobility,Scheduler,Routing,"
+                << "CiTarget,RunsUsed,Converged,"
+                << "PDR_mean,PDR_ci95,AvgLatency_ms_mean,AvgLatency_ms_ci95,AvgThroughput_kbps_mean,AvgThroughput_kbps_ci95\n";
+    }
+    std::streamsize precision = outFile.precision();
+    for (uint32_t p = 0; p < points.size(); ++p) {
+        const SimulationConfig& c = points[p];
+        outFile << c.nodesPerCluster << "," << c.simulationTime << "," << c.areaSize << ","
+                << c.followerSpeed << "," << c.noiseFactor << "," << c.packetSizei << "," << c.followerRate << ","
+                << FanoutLabel(c.clusterFanout) << "," << c.channel << "," << c.channelPlan << ","
+                << c.mobility << "," << c.scheduler << "," << c.routing << ","
+                << ciTarget << "," << results[p].size() << "," << (converged[p] ? 1 : 0);
+        for (const std::vector<double>& samples : metricSamples(p)) {
+            double mean = 0.0;
+            double halfWidth = ConfidenceHalfWidth(samples, &mean);
+            outFile << "," << std::fixed << std::setprecision(4) << mean << "," << halfWidth;
+        }
+        outFile.unsetf(std::ios_base::floatfield);
+        outFile.precision(precision);
+        outFile << "\n";
+        std::cout << "Point " << (p + 1) << "/" << points.size() << ": " << results[p].size() << " runs"
+                  << (converged[p] ? " (converged)" : " (maxRuns reached)") << std::endl;
+    }
+    outFile.close();
+    std::cout << "Convergence report saved to " << reportFileName << std::endl;
+}
+
+//================================================================================
+// 12. STREAMING TELEMETRY METRICS
+//================================================================================
+
+/**
+ * @param windowsFileName Where the windows are appended; empty disables the window output.
+ */
+TelemetryCollector::TelemetryCollector(const SimulationConfig& config, uint32_t runNumber, const std::string& windowsFileName)
+    : m_config(config),
+      m_runNumber(runNumber),
+      m_window(Seconds(config.window)),
+      m_windowStart(Seconds(0.0)),
+      m_rows(WindowResultsSchema()),
+      m_windows(0) {
+    if (!windowsFileName.empty()) {
+        std::string error;
+        NS_ABORT_MSG_IF(!m_file.Open(windowsFileName, WindowResultsSchema(), &error), error);
+    }
+}
+
+/**
+ * @brief Registers the flow sent by `source` in `cluster`; returns its index.
+ */
+uint32_t TelemetryCollector::AddFlow(uint32_t cluster, Ipv4Address source) {
+    uint32_t flow = m_flows.size();
+    m_flowCluster.push_back(cluster);
+    m_flowSource.push_back(source);
+    m_flows.push_back(WindowCounters());
+    m_latency.push_back(LatencyHistogram());
+    if (m_clusters.size() <= cluster) {
+        m_clusters.resize(cluster + 1, WindowCounters());
+    }
+    m_flowBySource[source.Get()] = flow;
+    return flow;
+}
+
+void TelemetryCollector::NotifyTx(uint32_t flow) {
+    Advance(Simulator::Now());
+    m_flows[flow].txPackets++;
+    m_clusters[m_flowCluster[flow]].txPackets++;
+}
+
+void TelemetryCollector::NotifyRx(const Address& from, uint32_t bytes, Time delay) {
+    auto it = m_flowBySource.find(InetSocketAddress::ConvertFrom(from).GetIpv4().Get());
+    if (it == m_flowBySource.end()) {
+        return;
+    }
+    Advance(Simulator::Now());
+    m_latency[it->second].Record(delay);
+    for (WindowCounters* counters : {&m_flows[it->second], &m_clusters[m_flowCluster[it->second]]}) {
+        counters->rxPackets++;
+        counters->rxBytes += bytes;
+        counters->delaySum += delay.GetSeconds() * 1000.0;
+    }
+}
+
+/**
+ * @brief Emits the windows that ended before `now`, including empty ones.
+ */
+void TelemetryCollector::Advance(Time now) {
+    if (!m_file.IsOpen()) {
+        return;
+    }
+    while (now >= m_windowStart + m_window) {
+        EmitWindow(m_window);
+        m_windowStart += m_window;
+    }
+}
+
+/**
+ * @brief Labels the rows with `runNumber` and writes them to `windowsFileName` from now on.
+ *
+ * Used by warm-start children, before any telemetry has been sent.
+ */
+void TelemetryCollector::Reopen(uint32_t runNumber, const std::string& windowsFileName) {
+    m_runNumber = runNumber;
+    m_file.Close();
+    if (!windowsFileName.empty()) {
+        std::string error;
+        NS_ABORT_MSG_IF(!m_file.Open(windowsFileName, WindowResultsSchema(), &error), error);
+    }
+}
+
+/**
+ * @brief Emits the last (possibly partial) window and flushes the remaining rows.
+ */
+void TelemetryCollector::Finish() {
+    if (!m_file.IsOpen()) {
+        return;
+    }
+    Time now = Simulator::Now();
+    Advance(now);
+    if (now > m_windowStart) {
+        EmitWindow(now - m_windowStart);
+    }
+    std::string error;
+    if (m_rows.GetRowCount() > 0) {
+        NS_ABORT_MSG_IF(!m_file.Append(m_rows, &error), error);
+        m_rows.Clear();
+    }
+    m_file.Close();
+}
+
+uint64_t TelemetryCollector::GetWindows() const {
+    return m_windows;
+}
+
+/**
+ * @brief Latency histogram of the flow sent from `source`, or null if there is no such flow.
+ */
+const LatencyHistogram* TelemetryCollector::FindLatencyHistogram(Ipv4Address source) const {
+    auto it = m_flowBySource.find(source.Get());
+    return (it != m_flowBySource.end()) ? &m_latency[it->second] : nullptr;
+}
+
+void TelemetryCollector::EmitWindow(Time length) {
+    double seconds = length.GetSeconds();
+    for (uint32_t f = 0; f < m_flows.size(); ++f) {
+        AddRow(m_flowCluster[f], m_flowSource[f], m_flows[f], seconds);
+        m_flows[f] = WindowCounters();
+    }
+    for (uint32_t c = 0; c < m_clusters.size(); ++c) {
+        AddRow(c, Ipv4Address::GetZero(), m_clusters[c], seconds);
+        m_clusters[c] = WindowCounters();
+    }
+    ++m_windows;
+}
+
+void TelemetryCollector::AddRow(uint32_t cluster, Ipv4Address source, const WindowCounters& counters, double length) {
+    double pdr = (counters.txPackets > 0) ? 100.0 * counters.rxPackets / counters.txPackets : 0.0;
+    double avgLatency = (counters.rxPackets > 0) ? counters.delaySum / counters.rxPackets : 0.0;
+    double throughput = (length > 0) ? counters.rxBytes * 8.0 / (length * 1000.0) : 0.0;
+
+    // Column order of WindowResultsSchema
+    m_rows.PutU32(0, m_runNumber);
+    m_rows.PutU32(1, m_config.nodesPerCluster);
+    m_rows.PutF64(2, m_config.followerSpeed);
+    m_rows.PutF64(3, m_config.noiseFactor);
+    m_rows.PutU32(4, m_config.packetSizei);
+    m_rows.PutF64(5, m_windowStart.GetSeconds());
+    m_rows.PutF64(6, length);
+    m_rows.PutU32(7, cluster);
+    m_rows.PutU32(8, source.Get());
+    m_rows.PutU32(9, counters.txPackets);
+    m_rows.PutU32(10, counters.rxPackets);
+    m_rows.PutU64(11, counters.rxBytes);
+    m_rows.PutF64(12, pdr);
+    m_rows.PutF64(13, avgLatency);
+    m_rows.PutF64(14, throughput);
+    m_rows.PutF64(15, m_config.followerRate);
+    NS_ABORT_MSG_IF(!m_rows.EndRow(), "Window row does not match the schema");
+
+    if (m_rows.GetRowCount() >= BlockRows) {
+        std::string error;
+        NS_ABORT_MSG_IF(!m_file.Append(m_rows, &error), error);
+        m_rows.Clear();
+    }
+}
+
+/**
+ * @brief OnOffApplication TxWithSeqTsSize sink of flow `flow`.
+ */
+void TelemetryTxTrace(TelemetryCollector* collector, uint32_t flow, Ptr<const Packet> packet, const Address& from, const Address& to, const SeqTsSizeHeader& header) {
+    collector->NotifyTx(flow);
+}
+
+/**
+ * @brief PacketSink RxWithSeqTsSize sink; the header carries the send time.
+ */
+void TelemetryRxTrace(TelemetryCollector* collector, Ptr<const Packet> packet, const Address& from, const Address& to, const SeqTsSizeHeader& header) {
+    collector->NotifyRx(from, packet->GetSize(), Simulator::Now() - header.GetTs());
+}
+
+// --- Latency Histogram ---
+
+LatencyHistogram::LatencyHistogram() : m_total(0), m_maxMicros(0) {
+    m_counts.fill(0);
+}
+
+uint32_t LatencyHistogram::BucketOf(uint64_t micros) {
+    if (micros < SubBuckets) {
+        return micros;
+    }
+    micros = std::min<uint64_t>(micros, 0xffffffffULL);
+    uint32_t exponent = 63 - __builtin_clzll(micros); // >= 4
+    uint32_t sub = (micros >> (exponent - 4)) & (SubBuckets - 1);
+    return SubBuckets + (exponent - 4) * SubBuckets + sub;
+}
+
+/**
+ * @brief Largest value that falls into `bucket`.
+ */
+uint64_t LatencyHistogram::BucketUpperBound(uint32_t bucket) {
+    if (bucket < SubBuckets) {
+        return bucket;
+    }
+    uint32_t exponent = (bucket - SubBuckets) / SubBuckets + 4;
+    uint64_t sub = (bucket - SubBuckets) % SubBuckets;
+    uint64_t width = 1ULL << (exponent - 4);
+    return (1ULL << exponent) + (sub + 1) * width - 1;
+}
+
+void LatencyHistogram::Record(Time latency) {
+    int64_t micros = latency.GetMicroSeconds();
+    uint64_t value = (micros > 0) ? static_cast<uint64_t>(micros) : 0;
+    m_counts[BucketOf(value)]++;
+    m_total++;
+    m_maxMicros = std::max(m_maxMicros, value);
+}
+
+uint64_t LatencyHistogram::GetCount() const {
+    return m_total;
+}
+
+/**
+ * @brief Latency in ms below which `percentile` % of the samples fall (bucket upper bound, capped at the max).
+ */
+double LatencyHistogram::GetPercentileMs(double percentile) const {
+    if (m_total == 0) {
+        return 0.0;
+    }
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(percentile / 100.0 * m_total)));
+    uint64_t seen = 0;
+    for (uint32_t b = 0; b < NumBuckets; ++b) {
+        seen += m_counts[b];
+        if (seen >= rank) {
+            return std::min(BucketUpperBound(b), m_maxMicros) / 1000.0;
+        }
+    }
+    return GetMaxMs();
+}
+
+double LatencyHistogram::GetMaxMs() const {
+    return m_maxMicros / 1000.0;
+}
+
+//================================================================================
+// 13. EVENT PROFILING
+//================================================================================
+
+EventProfile::EventProfile() : m_current(-1) {
+}
+
+/**
+ * @brief Closes the event being timed (if any) and starts timing one of `type`.
+ */
+void EventProfile::BeginEvent(const std::type_info& type) {
+    EndEvent();
+    auto it = m_index.find(&type);
+    if (it == m_index.end()) {
+        it = m_index.emplace(&type, m_stats.size()).first;
+        m_stats.push_back({&type, 0, 0});
+    }
+    m_current = it->second;
+    m_start = std::chrono::steady_clock::now();
+}
+
+void EventProfile::EndEvent() {
+    if (m_current < 0) {
+        return;
+    }
+    TypeStats& stats = m_stats[m_current];
+    stats.count++;
+    stats.nanos += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count();
+    m_current = -1;
+}
+
+std::string EventProfile::Demangle(const std::type_info& type) {
+    int status = 0;
+    char* name = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+    std::string result = (status == 0 && name != nullptr) ? name : type.name();
+    std::free(name);
+    return result;
+}
+
+/**
+ * @brief Coarse event source, from the names that appear in the event type.
+ */
+std::string EventProfile::Category(const std::string& name) {
+    static const char* const categories[][2] = {
+        {"HierarchicalMobilityController", "mobility"},
+        {"MobilityModel", "mobility"},
+        {"olsr", "olsr"},
+        {"OnOffApplication", "application"},
+        {"PacketSink", "application"},
+        {"Wifi", "wifi"},
+        {"Phy", "wifi"},
+        {"Txop", "wifi"},
+        {"ChannelAccess", "wifi"},
+        {"SpectrumChannel", "wifi"},
+        {"Arp", "ipv4"},
+        {"Ipv4", "ipv4"},
+        {"FlowMonitor", "flow-monitor"},
+        {"AnimationInterface", "netanim"},
+    };
+    for (const auto& category : categories) {
+        if (name.find(category[0]) != std::string::npos) {
+            return category[1];
+        }
+    }
+    return "other";
+}
+
+/**
+ * @brief Prints the types ranked by wall time to `table` and writes all of them to `fileName` as CSV.
+ */
+void EventProfile::Report(std::ostream& table, const std::string& fileName) const {
+    std::vector<TypeStats> ranked = m_stats;
+    std::sort(ranked.begin(), ranked.end(), [](const TypeStats& a, const TypeStats& b) { return a.nanos > b.nanos; });
+    uint64_t totalNanos = 0;
+    uint64_t totalEvents = 0;
+    for (const TypeStats& stats : ranked) {
+        totalNanos += stats.nanos;
+        totalEvents += stats.count;
+    }
+
+    std::ofstream outFile(fileName);
+    outFile << "Rank,Category,EventType,Events,WallTime_ms,WallTime_pct,NsPerEvent\n";
+    table << "Event profile: " << totalEvents << " events, " << totalNanos / 1e6 << " ms" << std::endl;
+    table << std::setw(4) << "#" << "  " << std::left << std::setw(12) << "category" << std::right
+          << std::setw(12) << "events" << std::setw(12) << "ms" << std::setw(8) << "%" << std::setw(10) << "ns/ev"
+          << "  type" << std::endl;
+    for (uint32_t r = 0; r < ranked.size(); ++r) {
+        const TypeStats& stats = ranked[r];
+        std::string name = Demangle(*stats.type);
+        std::string category = Category(name);
+        double ms = stats.nanos / 1e6;
+        double percent = (totalNanos > 0) ? 100.0 * stats.nanos / totalNanos : 0.0;
+        double nsPerEvent = (stats.count > 0) ? static_cast<double>(stats.nanos) / stats.count : 0.0;
+
+        std::string quoted = name;
+        for (size_t pos = quoted.find('"'); pos != std::string::npos; pos = quoted.find('"', pos + 2)) {
+            quoted.insert(pos, 1, '"');
+        }
+        outFile << r + 1 << "," << category << ",\"" << quoted << "\"," << stats.count << ","
+                << ms << "," << percent << "," << nsPerEvent << "\n";
+
+        if (r < 20) {
+            std::string shortName = (name.size() > 100) ? name.substr(0, 97) + "..." : name;
+            table << std::setw(4) << r + 1 << "  " << std::left << std::setw(12) << category << std::right
+                  << std::setw(12) << stats.count << std::setw(12) << std::fixed << std::setprecision(1) << ms
+                  << std::setw(8) << percent << std::setw(10) << std::setprecision(0) << nsPerEvent
+                  << std::defaultfloat << std::setprecision(6) << "  " << shortName << std::endl;
+        }
+    }
+    outFile.close();
+    std::cout << "Event profile saved to " << fileName << std::endl;
+}
+
+NS_OBJECT_ENSURE_REGISTERED(ProfilingScheduler);
+
+TypeId ProfilingScheduler::GetTypeId() {
+    static TypeId tid = TypeId("ProfilingScheduler")
+        .SetParent<Scheduler>()
+        .SetGroupName("Core")
+        .AddConstructor<ProfilingScheduler>()
+        .AddAttribute("InnerScheduler", "Scheduler the events are stored in.",
+                      StringValue("ns3::MapScheduler"),
+                      MakeStringAccessor(&ProfilingScheduler::SetInnerScheduler),
+                      MakeStringChecker());
+    return tid;
+}
+
+ProfilingScheduler::ProfilingScheduler() {
+    SetInnerScheduler("ns3::MapScheduler");
+}
+
+void ProfilingScheduler::SetInnerScheduler(std::string typeName) {
+    ObjectFactory factory(typeName);
+    m_inner = factory.Create<Scheduler>();
+}
+
+void ProfilingScheduler::Insert(const Event& ev) {
+    m_inner->Insert(ev);
+}
+
+bool ProfilingScheduler::IsEmpty() const {
+    return m_inner->IsEmpty();
+}
+
+Scheduler::Event ProfilingScheduler::PeekNext() const {
+    return m_inner->PeekNext();
+}
+
+/**
+ * @brief Hands out the next event; it is invoked right after this returns.
+ */
+Scheduler::Event ProfilingScheduler::RemoveNext() {
+    Event ev = m_inner->RemoveNext();
+    if (g_eventProfile != nullptr) {
+        g_eventProfile->BeginEvent(typeid(*ev.impl));
+    }
+    return ev;
+}
+
+void ProfilingScheduler::Remove(const Event& ev) {
+    m_inner->Remove(ev);
+}
+
+//================================================================================
+// 14. BENCHMARKS
+//================================================================================
+
+/**
+ * @brief Runs every sweep point once with each event scheduler and compares them.
+ *
+ * All runs use run number 1, so the schedulers execute the same event
+ * sequence. Reported per run: executed events, wall time of Simulator::Run,
+ * events per second and peak RSS. Every run gets its own process, so the
+ * peak RSS of one scheduler does not carry over to the next. With jobs > 1
+ * the runs share the machine, so use jobs=1 for timings that can be
+ * compared across points. The table is
+ * printed and appended to hierarchical_manet_scheduler_benchmark.csv; the
+ * flow statistics of the runs go to the usual results file.
+ */
+void RunSchedulerBenchmark(const std::vector<SimulationConfig>& points, uint32_t jobs) {
+    const std::vector<std::string> schedulers = {"map", "heap", "list", "calendar"};
+
+    std::vector<SimulationTask> tasks;
+    for (const SimulationConfig& point : points) {
+        for (const std::string& scheduler : schedulers) {
+            SimulationConfig config = point;
+            config.scheduler = scheduler;
+            tasks.push_back({config, 1, 1, EstimateTaskCost(config), RunSummary()});
+        }
+    }
+    std::cout << "Scheduler benchmark: " << points.size() << " points x " << schedulers.size() << " schedulers" << std::endl;
+    ExecuteTasksIsolated(tasks, jobs);
+
+    // --- Benchmark Report ---
+    std::string reportFileName = "hierarchical_manet_scheduler_benchmark.csv";
+    std::ifstream testFile(reportFileName);
+    bool fileExists = testFile.good();
+    testFile.close();
+
+    std::ofstream outFile(reportFileName, std::ios_base::app);
+    if (!fileExists) {
+        outFile << "Scheduler,NodesPerCluster,Nodes,SimTime,PacketSize,Events,SetupTime_s,RunTime_s,EventsPerSecond,PeakRss_kB\n";
+    }
+    // Rows set fixed notation and precision; both are restored after each row
+    std::streamsize outPrecision = outFile.precision();
+    std::streamsize coutPrecision = std::cout.precision();
+    std::cout << std::left << std::setw(10) << "Scheduler" << std::right << std::setw(8) << "Nodes"
+              << std::setw(14) << "Events" << std::setw(12) << "Run (s)" << std::setw(14) << "Events/s"
+              << std::setw(14) << "Peak RSS kB" << std::endl;
+    for (const SimulationTask& task : tasks) {
+        const RunSummary& r = task.summary;
+        NS_ABORT_MSG_IF(!r.valid, "Benchmark run with --scheduler=" << task.config.scheduler << " did not complete");
+        double eventsPerSecond = r.runTime > 0 ? r.events / r.runTime : 0.0;
+        outFile << task.config.scheduler << "," << task.config.nodesPerCluster << "," << r.nodes << ","
+                << task.config.simulationTime << "," << task.config.packetSizei << "," << r.events << ","
+                << std::fixed << std::setprecision(3) << r.setupTime << "," << r.runTime << ","
+                << std::setprecision(0) << eventsPerSecond << "," << r.peakRssKb << "\n";
+        outFile.unsetf(std::ios_base::floatfield);
+        outFile.precision(outPrecision);
+        std::cout << std::left << std::setw(10) << task.config.scheduler << std::right << std::setw(8) << r.nodes
+                  << std::setw(14) << r.events << std::setw(12) << std::fixed << std::setprecision(3) << r.runTime
+                  << std::setw(14) << std::setprecision(0) << eventsPerSecond << std::setw(14) << r.peakRssKb
+                  << std::endl;
+        std::cout.unsetf(std::ios_base::floatfield);
+        std::cout.precision(coutPrecision);
+    }
+    std::cout << "Scheduler benchmark saved to " << reportFileName << std::endl;
+}
+
+/**
+ * @brief Runs every sweep point and run once per routing scheme and compares them.
+ *
+ * Each scheme gets the same run numbers, hence the same seeds, mobility and
+ * traffic pattern. Per scheme and point the means over the runs of PDR,
+ * latency, control bytes, control/data ratio, convergence time (-1 for
+ * AODV, which has no convergence) and wall time are printed and appended
+ * to hierarchical_manet_routing_benchmark.csv; the per-flow and per-node
+ * rows go to the usual results files. Control bytes are counted at IP Tx,
+ * once per interface, for every scheme alike.
+ */
+void RunRoutingBenchmark(const std::vector<SimulationConfig>& points, uint32_t numRuns, uint32_t jobs) {
+    const std::vector<std::string> schemes = {"olsr", "static-hier", "aodv", "dsdv"};
+
+    std::vector<SimulationTask> tasks;
+    for (const SimulationConfig& point : points) {
+        for (const std::string& scheme : schemes) {
+            SimulationConfig config = point;
+            config.routing = scheme;
+            for (uint32_t run = 1; run <= numRuns; ++run) {
+                tasks.push_back({config, run, numRuns, EstimateTaskCost(config), RunSummary()});
+            }
+        }
+    }
+    std::cout << "Routing benchmark: " << points.size() << " points x " << schemes.size() << " schemes x "
+              << numRuns << " runs" << std::endl;
+    ExecuteTasks(tasks, jobs);
+
+    // --- Benchmark Report ---
+    std::string reportFileName = "hierarchical_manet_routing_benchmark.csv";
+    std::ifstream testFile(reportFileName);
+    bool fileExists = testFile.good();
+    testFile.close();
+
+    std::ofstream outFile(reportFileName, std::ios_base::app);
+    if (!fileExists) {
+        outFile << "Routing,NodesPerCluster,Nodes,SimTime,FollowerSpeed,PacketSize,OfferedRate_kbps,Runs,"
+                << "PDR,AvgLatency_ms,ControlBytes,ControlDataRatio,ConvergenceTime_s,WallTime_s\n";
+    }
+    // Rows set fixed notation and precision; both are restored after each row
+    std::streamsize outPrecision = outFile.precision();
+    std::streamsize coutPrecision = std::cout.precision();
+    std::cout << std::left << std::setw(13) << "Routing" << std::right << std::setw(8) << "Nodes"
+              << std::setw(9) << "PDR %" << std::setw(13) << "Latency ms" << std::setw(14) << "Ctrl bytes"
+              << std::setw(11) << "Ctrl/data" << std::setw(12) << "Conv. s" << std::setw(11) << "Wall s" << std::endl;
+    for (uint32_t first = 0; first < tasks.size(); first += numRuns) {
+        const SimulationConfig& c = tasks[first].config;
+        RunSummary mean = RunSummary();
+        double controlBytes = 0.0;
+        uint32_t converged = 0;
+        for (uint32_t i = first; i < first + numRuns; ++i) {
+            const RunSummary& r = tasks[i].summary;
+            NS_ABORT_MSG_IF(!r.valid, "Benchmark run with --routing=" << c.routing << " did not complete");
+            mean.nodes = r.nodes;
+            mean.pdr += r.pdr / numRuns;
+            mean.avgLatency += r.avgLatency / numRuns;
+            controlBytes += static_cast<double>(r.controlBytes) / numRuns;
+            mean.controlDataRatio += r.controlDataRatio / numRuns;
+            mean.wallTime += r.wallTime / numRuns;
+            if (r.convergenceTime >= 0) {
+                mean.convergenceTime += r.convergenceTime;
+                ++converged;
+            }
+        }
+        mean.convergenceTime = converged > 0 ? mean.convergenceTime / converged : -1.0;
+        // Proactive schemes must converge well before the timeout; if none did,
+        // the convergence check itself is broken for this scheme.
+        if (c.routing != "aodv" && converged == 0) {
+            std::cerr << "Warning: no --routing=" << c.routing << " run converged before --convergenceTimeout" << std::endl;
+        }
+        outFile << c.routing << "," << c.nodesPerCluster << "," << mean.nodes << "," << c.simulationTime << ","
+                << c.followerSpeed << "," << c.packetSizei << "," << c.followerRate << "," << numRuns << ","
+                << std::fixed << std::setprecision(4) << mean.pdr << "," << mean.avgLatency << ","
+                << controlBytes << "," << mean.controlDataRatio << "," << mean.convergenceTime << ","
+                << mean.wallTime << "\n";
+        outFile.unsetf(std::ios_base::floatfield);
+        outFile.precision(outPrecision);
+        std::cout << std::left << std::setw(13) << c.routing << std::right << std::setw(8) << mean.nodes
+                  << std::fixed << std::setprecision(2) << std::setw(9) << mean.pdr << std::setw(13) << mean.avgLatency
+                  << std::setprecision(0) << std::setw(14) << controlBytes << std::setprecision(4) << std::setw(11) << mean.controlDataRatio
+                  << std::setprecision(2) << std::setw(12) << mean.convergenceTime << std::setw(11) << mean.wallTime
+                  << std::endl;
+        std::cout.unsetf(std::ios_base::floatfield);
+        std::cout.precision(coutPrecision);
+    }
+    std::cout << "Routing benchmark saved to " << reportFileName << std::endl;
+}
+
+/**
+ * @brief Runs the scenario over a grid of nodesPerCluster x clusters x simTime
+ * and writes the cost of every point as JSON.
+ *
+ * Every point is run once with run number 1. The clusters hang directly
+ * under the super-leader (one hierarchy level), all other parameters come
+ * from `base`. Per point the file records wall time, setup time, run time,
+ * executed events, events per wall second, simulated seconds per wall
+ * second and peak RSS. Points are written one per line in grid order with a
+ * fixed key order, so two builds can be compared with a plain diff; the
+ * header line carries the build id. Every point runs in its own process,
+ * so its peak RSS does not depend on the grid order. Use jobs=1 for
+ * comparable timings.
+ */
+void RunScalingBenchmark(const SimulationConfig& base, const std::vector<uint32_t>& nodesPerClusterValues, const std::vector<uint32_t>& clusterValues, const std::vector<double>& simTimeValues, uint32_t jobs, const std::string& fileName) {
+    std::vector<SimulationTask> tasks;
+    for (uint32_t nodesPerCluster : nodesPerClusterValues) {
+        NS_ABORT_MSG_IF(nodesPerCluster < 2, "benchNodes values must be at least 2 (leader + one follower)");
+        for (uint32_t clusters : clusterValues) {
+            NS_ABORT_MSG_IF(clusters == 0, "benchClusters values must be at least 1");
+            for (double simTime : simTimeValues) {
+                NS_ABORT_MSG_IF(simTime <= 0, "benchSimTime values must be positive");
+                SimulationConfig config = base;
+                config.nodesPerCluster = nodesPerCluster;
+                config.clusterFanout = std::vector<uint32_t>(1, clusters);
+                config.formationRadius.clear();
+                config.simulationTime = simTime;
+                tasks.push_back({config, 1, 1, EstimateTaskCost(config), RunSummary()});
+            }
+        }
+    }
+    std::cout << "Scaling benchmark: " << tasks.size() << " points" << std::endl;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    ExecuteTasksIsolated(tasks, jobs);
+    double totalTime = SecondsSince(&start);
+
+    // --- Benchmark Report ---
+    std::ofstream outFile(fileName);
+    NS_ABORT_MSG_IF(!outFile.good(), "Cannot write " << fileName);
+    outFile << std::fixed;
+    outFile << "{\"buildId\":\"" << BinaryBuildId() << "\",\"scheduler\":\"" << base.scheduler
+            << "\",\"channel\":\"" << base.channel << "\",\"mobility\":\"" << base.mobility
+            << "\",\"jobs\":" << jobs << ",\"totalTime_s\":" << std::setprecision(3) << totalTime << ",\"points\":[\n";
+    for (uint32_t i = 0; i < tasks.size(); ++i) {
+        const SimulationConfig& c = tasks[i].config;
+        const RunSummary& r = tasks[i].summary;
+        NS_ABORT_MSG_IF(!r.valid, "Benchmark point " << i << " did not complete");
+        double eventsPerSecond = r.runTime > 0 ? r.events / r.runTime : 0.0;
+        double simPerWall = r.runTime > 0 ? c.simulationTime / r.runTime : 0.0;
+        outFile << "{\"nodesPerCluster\":" << c.nodesPerCluster
+                << ",\"clusters\":" << c.clusterFanout.front()
+                << ",\"simTime\":" << std::setprecision(1) << c.simulationTime
+                << ",\"nodes\":" << r.nodes
+                << ",\"wallTime_s\":" << std::setprecision(3) << r.wallTime
+                << ",\"setupTime_s\":" << r.setupTime
+                << ",\"runTime_s\":" << r.runTime
+                << ",\"events\":" << r.events
+                << ",\"eventsPerSecond\":" << std::setprecision(0) << eventsPerSecond
+                << ",\"simSecondsPerWallSecond\":" << std::setprecision(4) << simPerWall
+                << ",\"peakRss_kB\":" << r.peakRssKb
+                << "}" << (i + 1 < tasks.size() ? "," : "") << "\n";
+        std::cout << "n=" << c.nodesPerCluster << " clusters=" << c.clusterFanout.front() << " simTime=" << c.simulationTime
+                  << ": " << r.wallTime << " s wall, " << eventsPerSecond << " events/s, " << r.peakRssKb << " kB" << std::endl;
+    }
+    outFile << "]}\n";
+    std::cout << "Scaling benchmark saved to " << fileName << std::endl;
+}
+
+//================================================================================
+// 15. ROUTING CONVERGENCE
+//================================================================================
+
+RouteConvergenceMonitor::RouteConvergenceMonitor(Time interval, Time timeout)
+    : m_interval(interval),
+      m_timeout(timeout),
+      m_next(0),
+      m_confirming(false),
+      m_convergenceTime(-1.0),
+      m_checks(0) {
+}
+
+/**
+ * @brief Requires a route from `node` to `destination`.
+ */
+void RouteConvergenceMonitor::AddRoute(Ptr<Node> node, Ipv4Address destination) {
+    m_nodes.push_back(node->GetObject<Ipv4>());
+    m_destinations.push_back(destination);
+}
+
+/**
+ * @brief Checks at `first` and every interval after; `onDone` (may be empty)
+ * runs once, on convergence or at the timeout.
+ */
+void RouteConvergenceMonitor::Start(Time first, std::function<void()> onDone) {
+    m_onDone = onDone;
+    Simulator::Schedule(first - Simulator::Now(), &RouteConvergenceMonitor::Check, this);
+}
+
+double RouteConvergenceMonitor::GetConvergenceTime() const {
+    return m_convergenceTime;
+}
+
+uint32_t RouteConvergenceMonitor::GetRoutes() const {
+    return m_nodes.size();
+}
+
+uint64_t RouteConvergenceMonitor::GetChecks() const {
+    return m_checks;
+}
+
+bool RouteConvergenceMonitor::HasRoute(uint32_t index) const {
+    Ptr<Ipv4RoutingProtocol> routing = m_nodes[index]->GetRoutingProtocol();
+    Ipv4Header header;
+    header.SetDestination(m_destinations[index]);
+    Socket::SocketErrno error;
+    Ptr<Packet> probe = Create<Packet>(); // Never sent; a protocol may tag it while looking up
+    Ptr<Ipv4Route> route = routing->RouteOutput(probe, header, Ptr<NetDevice>(), error);
+    return route && !route->GetGateway().IsLocalhost();
+}
+
+void RouteConvergenceMonitor::Check() {
+    while (m_next < m_nodes.size()) {
+        ++m_checks;
+        if (!HasRoute(m_next)) {
+            break;
+        }
+        ++m_next;
+    }
+    if (m_next == m_nodes.size()) {
+        if (m_confirming) {
+            m_convergenceTime = Simulator::Now().GetSeconds();
+        } else {
+            // Routes seen earlier in the scan may have gone since; confirm in one pass
+            m_confirming = true;
+            m_next = 0;
+            Check();
+            return;
+        }
+    } else {
+        m_confirming = false;
+    }
+
+    if (m_convergenceTime >= 0 || Simulator::Now() >= m_timeout) {
+        if (m_onDone) {
+            m_onDone();
+        }
+        return;
+    }
+    Simulator::Schedule(m_interval, &RouteConvergenceMonitor::Check, this);
+}
+
+//================================================================================
+// 16. ROUTING CONTROL OVERHEAD
+//================================================================================
+
+ControlOverheadCounter::ControlOverheadCounter(uint32_t nodes)
+    : m_nodes(nodes, Counters()) {
+}
+
+/**
+ * @brief Splits the messages of one OLSR packet by type; the packet itself is counted at IP Tx.
+ */
+void ControlOverheadCounter::NotifyTx(uint32_t node, const olsr::PacketHeader& header, const olsr::MessageList& messages) {
+    Counters& counters = m_nodes[node];
+    for (const olsr::MessageHeader& message : messages) {
+        switch (message.GetMessageType()) {
+        case olsr::MessageHeader::HELLO_MESSAGE:
+            counters.helloMessages++;
+            counters.helloBytes += message.GetSerializedSize();
+            break;
+        case olsr::MessageHeader::TC_MESSAGE:
+            counters.tcMessages++;
+            counters.tcBytes += message.GetSerializedSize();
+            break;
+        case olsr::MessageHeader::HNA_MESSAGE:
+            counters.hnaMessages++;
+            counters.hnaBytes += message.GetSerializedSize();
+            break;
+        default:
+            break; // MID (leaders with two OLSR interfaces): only in the packet totals
+        }
+    }
+}
+
+void ControlOverheadCounter::NotifyRoutingTableChanged(uint32_t node) {
+    m_nodes[node].recomputations++;
+}
+
+/**
+ * @brief Counts one control packet sent on one interface; `bytes` at the IP level.
+ */
+void ControlOverheadCounter::NotifyControlPacket(uint32_t node, uint32_t bytes) {
+    m_nodes[node].packets++;
+    m_nodes[node].bytes += bytes;
+}
+
+const ControlOverheadCounter::Counters& ControlOverheadCounter::GetNode(uint32_t node) const {
+    return m_nodes[node];
+}
+
+ControlOverheadCounter::Counters ControlOverheadCounter::GetTotal() const {
+    Counters total = Counters();
+    for (const Counters& counters : m_nodes) {
+        total.helloMessages += counters.helloMessages;
+        total.helloBytes += counters.helloBytes;
+        total.tcMessages += counters.tcMessages;
+        total.tcBytes += counters.tcBytes;
+        total.hnaMessages += counters.hnaMessages;
+        total.hnaBytes += counters.hnaBytes;
+        total.packets += counters.packets;
+        total.bytes += counters.bytes;
+        total.recomputations += counters.recomputations;
+    }
+    return total;
+}
+
+void OlsrTxTrace(ControlOverheadCounter* counter, uint32_t node, const olsr::PacketHeader& header, const olsr::MessageList& messages) {
+    counter->NotifyTx(node, header, messages);
+}
+
+void OlsrRoutingTableTrace(ControlOverheadCounter* counter, uint32_t node, uint32_t size) {
+    counter->NotifyRoutingTableChanged(node);
+}
+
+/**
+ * @brief IPv4 Tx trace: counts the packet if it is UDP to the routing protocol's `port`.
+ *
+ * The control counting point of every scheme (OLSR 698, AODV 654, DSDV 269).
+ */
+void RoutingControlTxTrace(ControlOverheadCounter* counter, uint16_t port, uint32_t node, Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface) {
+    Ptr<Packet> copy = packet->Copy();
+    Ipv4Header ipHeader;
+    copy->RemoveHeader(ipHeader);
+    if (ipHeader.GetProtocol() != 17) {
+        return;
+    }
+    UdpHeader udpHeader;
+    copy->PeekHeader(udpHeader);
+    if (udpHeader.GetDestinationPort() == port) {
+        counter->NotifyControlPacket(node, packet->GetSize());
+    }
+}
+
+//================================================================================
+// 17. TELEMETRY AGGREGATION UPLINK
+//================================================================================
+
+NS_OBJECT_ENSURE_REGISTERED(TelemetryBatchHeader);
+
+TypeId TelemetryBatchHeader::GetTypeId() {
+    static TypeId tid = TypeId("TelemetryBatchHeader")
+        .SetParent<Header>()
+        .SetGroupName("Applications")
+        .AddConstructor<TelemetryBatchHeader>();
+    return tid;
+}
+
+TypeId TelemetryBatchHeader::GetInstanceTypeId() const {
+    return GetTypeId();
+}
+
+uint32_t TelemetryBatchHeader::GetSerializedSize() const {
+    return 2 + 12 * m_records.size();
+}
+
+void TelemetryBatchHeader::Serialize(Buffer::Iterator start) const {
+    start.WriteHtonU16(m_records.size());
+    for (const Record& record : m_records) {
+        start.WriteHtonU64(record.sent.GetNanoSeconds());
+        start.WriteHtonU32(record.bytes);
+    }
+}
+
+uint32_t TelemetryBatchHeader::Deserialize(Buffer::Iterator start) {
+    m_records.resize(start.ReadNtohU16());
+    for (Record& record : m_records) {
+        record.sent = NanoSeconds(start.ReadNtohU64());
+        record.bytes = start.ReadNtohU32();
+    }
+    return GetSerializedSize();
+}
+
+void TelemetryBatchHeader::Print(std::ostream& os) const {
+    os << "records=" << m_records.size();
+}
+
+void TelemetryBatchHeader::AddRecord(Time sent, uint32_t bytes) {
+    m_records.push_back({sent, bytes});
+}
+
+void TelemetryBatchHeader::Clear() {
+    m_records.clear();
+}
+
+const std::vector<TelemetryBatchHeader::Record>& TelemetryBatchHeader::GetRecords() const {
+    return m_records;
+}
+
+NS_OBJECT_ENSURE_REGISTERED(TelemetryAggregator);
+
+TypeId TelemetryAggregator::GetTypeId() {
+    static TypeId tid = TypeId("TelemetryAggregator")
+        .SetParent<Application>()
+        .SetGroupName("Applications")
+        .AddConstructor<TelemetryAggregator>()
+        .AddAttribute("Remote", "Address the batches are sent to (the super-leader).",
+                      AddressValue(),
+                      MakeAddressAccessor(&TelemetryAggregator::m_remote),
+                      MakeAddressChecker())
+        .AddAttribute("BatchSize", "Records per batch; a full batch is sent at once.",
+                      UintegerValue(16),
+                      MakeUintegerAccessor(&TelemetryAggregator::m_batchSize),
+                      MakeUintegerChecker<uint32_t>(1))
+        .AddAttribute("FlushDeadline", "Time after its first record a partial batch is sent.",
+                      TimeValue(MilliSeconds(100)),
+                      MakeTimeAccessor(&TelemetryAggregator::m_flushDeadline),
+                      MakeTimeChecker());
+    return tid;
+}
+
+TelemetryAggregator::TelemetryAggregator()
+    : m_batchSize(16), m_batchBytes(0), m_recordsSent(0), m_batchesSent(0) {
+}
+
+void TelemetryAggregator::DoDispose() {
+    m_socket = nullptr;
+    Application::DoDispose();
+}
+
+void TelemetryAggregator::StartApplication() {
+    m_socket = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+    m_socket->Bind();
+    m_socket->Connect(m_remote);
+}
+
+void TelemetryAggregator::StopApplication() {
+    if (m_socket) {
+        Flush();
+        m_socket->Close();
+        m_socket = nullptr;
+    }
+}
+
+/**
+ * @brief Adds one received telemetry packet (its send time and size) to the current batch.
+ *
+ * A record that would push the packet past the UDP limit sends the batch
+ * first. Records arriving while the application is stopped are dropped.
+ */
+void TelemetryAggregator::Enqueue(Time sent, uint32_t bytes) {
+    if (!m_socket) {
+        return;
+    }
+    uint32_t headerSize = m_batch.GetSerializedSize();
+    if (!m_batch.GetRecords().empty() && headerSize + 12 + m_batchBytes + bytes > MaxPayload) {
+        Flush();
+    }
+    if (m_batch.GetRecords().empty()) {
+        m_flushEvent = Simulator::Schedule(m_flushDeadline, &TelemetryAggregator::Flush, this);
+    }
+    m_batch.AddRecord(sent, bytes);
+    m_batchBytes += bytes;
+    if (m_batch.GetRecords().size() >= m_batchSize) {
+        Flush();
+    }
+}
+
+/**
+ * @brief Sends the current batch, if any, as one packet: the telemetry bytes behind a TelemetryBatchHeader.
+ */
+void TelemetryAggregator::Flush() {
+    m_flushEvent.Cancel();
+    if (m_batch.GetRecords().empty()) {
+        return;
+    }
+    Ptr<Packet> packet = Create<Packet>(m_batchBytes);
+    packet->AddHeader(m_batch);
+    m_socket->Send(packet);
+    m_recordsSent += m_batch.GetRecords().size();
+    m_batchesSent++;
+    m_batch.Clear();
+    m_batchBytes = 0;
+}
+
+uint64_t TelemetryAggregator::GetRecordsSent() const {
+    return m_recordsSent;
+}
+
+uint64_t TelemetryAggregator::GetBatchesSent() const {
+    return m_batchesSent;
+}
+
+/**
+ * @brief Leader PacketSink RxWithSeqTsSize sink feeding the aggregator; the header carries the follower's send time.
+ */
+void AggregatorRxTrace(TelemetryAggregator* aggregator, Ptr<const Packet> packet, const Address& from, const Address& to, const SeqTsSizeHeader& header) {
+    aggregator->Enqueue(header.GetTs(), header.GetSize());
+}
+
+/**
+ * @brief Super-leader PacketSink Rx sink: unpacks a batch and records the latency of every record in it.
+ */
+void UplinkRxTrace(UplinkStats* stats, Ptr<const Packet> packet, const Address& from) {
+    Time now = Simulator::Now();
+    Ptr<Packet> copy = packet->Copy();
+    TelemetryBatchHeader batch;
+    copy->RemoveHeader(batch);
+    if (stats->batches == 0) {
+        stats->firstRx = now;
+    }
+    stats->lastRx = now;
+    stats->batches++;
+    stats->bytes += packet->GetSize();
+    for (const TelemetryBatchHeader::Record& record : batch.GetRecords()) {
+        stats->records++;
+        stats->recordBytes += record.bytes;
+        stats->delaySum += now - record.sent;
+        stats->latency.Record(now - record.sent);
+    }
+}
+
+//================================================================================
+// 18. SATURATION CAPACITY SEARCH
+//================================================================================
+
+/**
+ * @brief Finds, per sweep point, the highest per-follower offered rate at which
+ * the mean PDR and mean p95 latency over numRuns replications meet `target`.
+ *
+ * The p95 of a run is averaged over the flows that received packets only
+ * (a flow that received nothing has no latency, it lowers the PDR); a run
+ * in which no flow received anything fails the latency check.
+ * The rate is the searched parameter, so points differing only in
+ * followerRate are searched once. Every point is first probed at both ends
+ * of the range; if the lowest rate already fails, or the highest still
+ * holds, that is the result. Otherwise the bracket between the highest
+ * holding and the lowest failing rate is bisected (geometrically, as rates
+ * span orders of magnitude) until it is narrower than the tolerance. Each
+ * round runs the next probe of every unfinished point as one ExecuteTasks
+ * batch, and every probe uses run numbers 1..numRuns, so all rates of a
+ * point see the same seeds. One capacity-curve row per point is appended
+ * to target.fileName; the per-flow rows of every probe go to the usual
+ * results files.
+ */
+void RunCapacitySearch(const std::vector<SimulationConfig>& points, uint32_t numRuns, uint32_t jobs, const CapacityTarget& target) {
+    // --- Distinct points, the offered rate aside ---
+    std::vector<SimulationConfig> searchPoints;
+    std::vector<std::string> keys;
+    for (SimulationConfig point : points) {
+        point.followerRate = 0.0;
+        std::string key = ConfigJson(point);
+        if (std::find(keys.begin(), keys.end(), key) == keys.end()) {
+            keys.push_back(key);
+            searchPoints.push_back(point);
+        }
+    }
+
+    // Highest holding and lowest failing rate of every point, -1 until probed
+    struct Bracket {
+        double holds;
+        double fails;
+        double pdr;             // Means at the holding rate
+        double p95Latency;
+        uint32_t nodes;
+        uint32_t probes;
+        bool done;
+    };
+    std::vector<Bracket> brackets(searchPoints.size(), Bracket{-1.0, -1.0, 0.0, 0.0, 0, 0, false});
+
+    std::cout << "Capacity search: " << searchPoints.size() << " points x " << numRuns << " runs per probe, target PDR >= "
+              << target.pdr << " %, p95 latency <= " << target.p95Latency << " ms, rates "
+              << target.minRate << "-" << target.maxRate << " kbps" << std::endl;
+    for (uint32_t round = 1;; ++round) {
+        // --- Next probe of every unfinished point ---
+        std::vector<SimulationTask> tasks;
+        std::vector<uint32_t> taskPoint;
+        for (uint32_t p = 0; p < searchPoints.size(); ++p) {
+            if (brackets[p].done) {
+                continue;
+            }
+            std::vector<double> rates;
+            if (round == 1) {
+                rates = {target.minRate, target.maxRate};
+            } else {
+                rates = {std::sqrt(brackets[p].holds * brackets[p].fails)};
+            }
+            for (double rate : rates) {
+                SimulationConfig config = searchPoints[p];
+                config.followerRate = rate;
+                for (uint32_t run = 1; run <= numRuns; ++run) {
+                    tasks.push_back({config, run, numRuns, EstimateTaskCost(config), RunSummary()});
+                    taskPoint.push_back(p);
+                }
+            }
+        }
+        if (tasks.empty()) {
+            break;
+        }
+        std::cout << "Capacity search round " << round << ": " << tasks.size() << " runs" << std::endl;
+        ExecuteTasks(tasks, jobs);
+
+        // --- Evaluate the probes (numRuns consecutive tasks each) ---
+        for (uint32_t first = 0; first < tasks.size(); first += numRuns) {
+            uint32_t p = taskPoint[first];
+            const SimulationConfig& c = tasks[first].config;
+            RunSummary mean = RunSummary();
+            for (uint32_t i = first; i < first + numRuns; ++i) {
+                const RunSummary& r = tasks[i].summary;
+                NS_ABORT_MSG_IF(!r.valid, "Capacity probe run " << tasks[i].runNumber << " did not complete");
+                mean.nodes = r.nodes;
+                mean.pdr += r.pdr / numRuns;
+                mean.p95Latency += r.p95Latency / numRuns;
+            }
+            bool holds = mean.pdr >= target.pdr && mean.p95Latency <= target.p95Latency;
+            Bracket& bracket = brackets[p];
+            bracket.nodes = mean.nodes;
+            bracket.probes++;
+            if (holds && c.followerRate > bracket.holds) {
+                bracket.holds = c.followerRate;
+                bracket.pdr = mean.pdr;
+                bracket.p95Latency = mean.p95Latency;
+            }
+            if (!holds && (bracket.fails < 0 || c.followerRate < bracket.fails)) {
+                bracket.fails = c.followerRate;
+            }
+            std::cout << "  nodesPerCluster " << c.nodesPerCluster << ", packet " << c.packetSizei << " B, "
+                      << c.followerRate << " kbps: PDR " << mean.pdr << " %, p95 " << mean.p95Latency << " ms -> "
+                      << (holds ? "holds" : "fails") << std::endl;
+        }
+
+        // --- Finished points ---
+        // Below the range (the lowest rate fails), above it (the highest
+        // holds) or bracketed to the tolerance.
+        for (Bracket& bracket : brackets) {
+            if (!bracket.done) {
+                bracket.done = bracket.holds < 0 || bracket.fails < 0 || bracket.fails <= bracket.holds * (1.0 + target.tolerance);
+            }
+        }
+    }
+
+    // --- Capacity Curve ---
+    std::ifstream testFile(target.fileName);
+    bool fileExists = testFile.good();
+    testFile.close();
+
+    std::ofstream outFile(target.fileName, std::ios_base::app);
+    if (!fileExists) {
+        outFile << "NodesPerCluster,Nodes,FollowerSpeed,NoiseFactor,PacketSize,Routing,Runs,TargetPDR,TargetP95Latency_ms,"
+                << "Probes,Capacity_kbps,FailingRate_kbps,PDR,P95Latency_ms,AggregateCapacity_kbps\n";
+    }
+    // Rows set fixed notation and precision; both are restored after each row
+    std::streamsize outPrecision = outFile.precision();
+    std::streamsize coutPrecision = std::cout.precision();
+    std::cout << std::right << std::setw(8) << "Nodes/cl" << std::setw(9) << "Packet" << std::setw(15) << "Capacity kbps"
+              << std::setw(14) << "Failing kbps" << std::setw(9) << "PDR %" << std::setw(10) << "p95 ms"
+              << std::setw(16) << "Aggregate kbps" << std::endl;
+    for (uint32_t p = 0; p < searchPoints.size(); ++p) {
+        const SimulationConfig& c = searchPoints[p];
+        const Bracket& bracket = brackets[p];
+        // 0 = the lowest rate already fails; a failing rate of -1 = the highest still holds
+        double capacityRate = std::max(bracket.holds, 0.0);
+        double aggregate = capacityRate * CountClusters(c) * (c.nodesPerCluster - 1);
+        outFile << c.nodesPerCluster << "," << bracket.nodes << "," << c.followerSpeed << "," << c.noiseFactor << ","
+                << c.packetSizei << "," << c.routing << "," << numRuns << "," << target.pdr << "," << target.p95Latency << ","
+                << bracket.probes << "," << capacityRate << "," << bracket.fails << ","
+                << std::fixed << std::setprecision(4) << bracket.pdr << "," << bracket.p95Latency << ","
+                << aggregate << "\n";
+        outFile.unsetf(std::ios_base::floatfield);
+        outFile.precision(outPrecision);
+        std::cout << std::setw(8) << c.nodesPerCluster << std::setw(9) << c.packetSizei
+                  << std::fixed << std::setprecision(1) << std::setw(15) << capacityRate << std::setw(14) << bracket.fails
+                  << std::setprecision(2) << std::setw(9) << bracket.pdr << std::setw(10) << bracket.p95Latency
+                  << std::setprecision(1) << std::setw(16) << aggregate << std::endl;
+        std::cout.unsetf(std::ios_base::floatfield);
+        std::cout.precision(coutPrecision);
+    }
+    std::cout << "Capacity curve saved to " << target.fileName << std::endl;
 }
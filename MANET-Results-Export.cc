@@ -0,0 +1,128 @@
+/**
+ * @file
+ * @brief Exports a binary results file written by MANET-Jerarquica to CSV.
+ *
+ * Usage: MANET-Results-Export <results.bin> [output.csv]
+ *
+ * Without an output file the CSV goes to stdout. The header row and the
+ * number formatting follow the column table stored in the file, so the
+ * flow statistics come out exactly as the former per-packet-size CSVs
+ * (filter on the PacketSize column to split them again).
+ *
+ * Depends only on MANET-Results.h, e.g.
+ *   g++ -O2 -std=c++17 -o MANET-Results-Export MANET-Results-Export.cc
+ */
+
+//================================================================================
+// 1. INCLUDES
+//================================================================================
+#include "MANET-Results.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//================================================================================
+// 2. CSV FORMATTING
+//================================================================================
+
+/**
+ * @brief Appends value `row` of `column` to `out` using the column's type and precision.
+ */
+void AppendCsvValue(const ResultsBlock& block, uint32_t column, uint32_t row, std::string& out) {
+    const ResultsColumn& spec = block.GetSchema()[column];
+    char text[64];
+    int length = 0;
+    switch (spec.type) {
+    case RESULTS_U32:
+        length = std::snprintf(text, sizeof(text), "%" PRIu32, block.GetU32(column, row));
+        break;
+    case RESULTS_U64:
+        length = std::snprintf(text, sizeof(text), "%" PRIu64, block.GetU64(column, row));
+        break;
+    case RESULTS_F64:
+        if (spec.precision < 0) {
+            length = std::snprintf(text, sizeof(text), "%g", block.GetF64(column, row));
+        } else {
+            length = std::snprintf(text, sizeof(text), "%.*f", spec.precision, block.GetF64(column, row));
+        }
+        break;
+    case RESULTS_IPV4: {
+        uint32_t address = block.GetU32(column, row);
+        length = std::snprintf(text, sizeof(text), "%u.%u.%u.%u", (address >> 24) & 0xff, (address >> 16) & 0xff,
+                               (address >> 8) & 0xff, address & 0xff);
+        break;
+    }
+    case RESULTS_LABEL:
+        length = std::snprintf(text, sizeof(text), "%s", block.GetLabel(column, row).c_str());
+        break;
+    }
+    out.append(text, length);
+}
+
+//================================================================================
+// 3. MAIN FUNCTION
+//================================================================================
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " <results.bin> [output.csv]" << std::endl;
+        return 2;
+    }
+
+    std::string error;
+    ResultsFileReader reader;
+    if (!reader.Open(argv[1], &error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    FILE* out = stdout;
+    if (argc == 3) {
+        out = std::fopen(argv[2], "w");
+        if (out == nullptr) {
+            std::cerr << "cannot open " << argv[2] << std::endl;
+            return 1;
+        }
+    }
+
+    // --- Header Row ---
+    const std::vector<ResultsColumn>& schema = reader.GetSchema();
+    std::string buffer;
+    for (uint32_t c = 0; c < schema.size(); ++c) {
+        buffer += (c > 0 ? "," : "") + schema[c].name;
+    }
+    buffer += '\n';
+
+    // --- Data Rows (one block per run, flushed per block) ---
+    ResultsBlock block(schema);
+    uint64_t rows = 0;
+    uint64_t blocks = 0;
+    while (reader.NextBlock(&block)) {
+        for (uint32_t r = 0; r < block.GetRowCount(); ++r) {
+            for (uint32_t c = 0; c < schema.size(); ++c) {
+                if (c > 0) {
+                    buffer += ',';
+                }
+                AppendCsvValue(block, c, r, buffer);
+            }
+            buffer += '\n';
+        }
+        std::fwrite(buffer.data(), 1, buffer.size(), out);
+        buffer.clear();
+        rows += block.GetRowCount();
+        ++blocks;
+    }
+    std::fwrite(buffer.data(), 1, buffer.size(), out);
+
+    if (out != stdout) {
+        std::fclose(out);
+    }
+    std::cerr << "Exported " << rows << " rows from " << blocks << " runs" << std::endl;
+    if (reader.IsCorrupt()) {
+        std::cerr << "Stopped at a block with a bad checksum; later runs were not exported" << std::endl;
+        return 1;
+    }
+    return 0;
+}
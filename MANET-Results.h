@@ -0,0 +1,617 @@
+/**
+ * @file
+ * @brief Binary columnar results file shared by the simulator and the exporter.
+ *
+ * Layout (native little-endian):
+ *
+ *   File header   "MANETRES" | uint32 version | uint32 columnCount
+ *   Column table  per column: uint8 type | int8 precision | uint8 nameLength | name
+ *   Blocks        uint32 "BLK1" | uint32 rowCount | uint64 payloadBytes | uint64 checksum
+ *                 payload: each column stored contiguously, rowCount values per column
+ *
+ * A block holds the rows of one run and is written with a single append, so
+ * the file grows by whole blocks. An interrupted append leaves a short last
+ * block, which readers ignore and the next writer truncates away. The
+ * checksum (FNV-1a over the payload) is verified by the reader.
+ *
+ * Only the C++ standard library and POSIX are used, so the exporter builds
+ * without ns-3.
+ */
+
+#ifndef MANET_RESULTS_H
+#define MANET_RESULTS_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+#include <unistd.h>
+
+//================================================================================
+// 1. SCHEMA
+//================================================================================
+
+enum ResultsColumnType : uint8_t {
+    RESULTS_U32 = 1,
+    RESULTS_U64 = 2,
+    RESULTS_F64 = 3,
+    RESULTS_IPV4 = 4, // uint32 in host order, exported as a dotted quad
+    RESULTS_LABEL = 5, // Short text (routing scheme, channel model...), NUL-padded
+};
+
+static const uint32_t RESULTS_LABEL_WIDTH = 16;
+
+/**
+ * @brief One column: name, storage type and CSV precision (-1 = shortest %g form).
+ */
+struct ResultsColumn {
+    std::string name;
+    ResultsColumnType type;
+    int8_t precision;
+};
+
+inline uint32_t ResultsColumnWidth(ResultsColumnType type) {
+    if (type == RESULTS_LABEL) {
+        return RESULTS_LABEL_WIDTH;
+    }
+    return (type == RESULTS_U64 || type == RESULTS_F64) ? 8 : 4;
+}
+
+/**
+ * @brief Per-flow statistics written by RunSimulation, one row per telemetry flow.
+ *
+ * The first columns reproduce the former per-packet-size CSV files; the
+ * latency percentiles come from the per-flow LatencyHistogram, and the last
+ * columns repeat the cost of the run (phase wall times, peak RSS, events)
+ * on each of its rows. The Uplink columns are the leader-to-super-leader
+ * aggregation uplink of the run (zero when --uplinkBatch=0). RunId is unique
+ * to the run, also across sweeps and benchmarks sharing the file, and is the
+ * runId of its manifest line; RunNumber repeats across routing schemes. The
+ * label columns after it complete the scenario, so every row describes its
+ * run (ClusterFanout as in "10x4", one entry per level).
+ */
+inline const std::vector<ResultsColumn>& FlowResultsSchema() {
+    static const std::vector<ResultsColumn> schema = {
+        {"RunNumber", RESULTS_U32, -1},
+        {"NodesPerCluster", RESULTS_U32, -1},
+        {"SimTime", RESULTS_F64, -1},
+        {"AreaSize", RESULTS_F64, -1},
+        {"FollowerSpeed", RESULTS_F64, -1},
+        {"NoiseFactor", RESULTS_F64, -1},
+        {"PacketSize", RESULTS_U32, -1},
+        {"FlowID", RESULTS_U32, -1},
+        {"SourceAddress", RESULTS_IPV4, -1},
+        {"DestinationAddress", RESULTS_IPV4, -1},
+        {"TxPackets", RESULTS_U32, -1},
+        {"RxPackets", RESULTS_U32, -1},
+        {"TxBytes", RESULTS_U64, -1},
+        {"RxBytes", RESULTS_U64, -1},
+        {"PacketDeliveryRatio", RESULTS_F64, 2},
+        {"AvgLatency_ms", RESULTS_F64, 2},
+        {"AvgThroughput_kbps", RESULTS_F64, 2},
+        {"P50Latency_ms", RESULTS_F64, 2},
+        {"P95Latency_ms", RESULTS_F64, 2},
+        {"P99Latency_ms", RESULTS_F64, 2},
+        {"MaxLatency_ms", RESULTS_F64, 2},
+        {"TopologyTime_s", RESULTS_F64, -1},
+        {"StackTime_s", RESULTS_F64, -1},
+        {"AppsTime_s", RESULTS_F64, -1},
+        {"RunTime_s", RESULTS_F64, -1},
+        {"ExportTime_s", RESULTS_F64, -1},
+        {"PeakRss_kB", RESULTS_U64, -1},
+        {"Events", RESULTS_U64, -1},
+        {"OfferedRate_kbps", RESULTS_F64, -1},
+        {"ConvergenceTime_s", RESULTS_F64, -1},
+        {"TrafficStart_s", RESULTS_F64, -1},
+        {"HelloMessages", RESULTS_U64, -1},
+        {"HelloBytes", RESULTS_U64, -1},
+        {"TcMessages", RESULTS_U64, -1},
+        {"TcBytes", RESULTS_U64, -1},
+        {"HnaMessages", RESULTS_U64, -1},
+        {"HnaBytes", RESULTS_U64, -1},
+        {"ControlBytes", RESULTS_U64, -1},
+        {"ControlDataRatio", RESULTS_F64, 4},
+        {"RouteRecomputations", RESULTS_U64, -1},
+        {"UplinkRecordsSent", RESULTS_U64, -1},
+        {"UplinkRecords", RESULTS_U64, -1},
+        {"UplinkBatches", RESULTS_U64, -1},
+        {"UplinkBytes", RESULTS_U64, -1},
+        {"BackboneGoodput_kbps", RESULTS_F64, 2},
+        {"UplinkLatencyAvg_ms", RESULTS_F64, 2},
+        {"UplinkLatencyP95_ms", RESULTS_F64, 2},
+        {"RunId", RESULTS_U64, -1},
+        {"Routing", RESULTS_LABEL, -1},
+        {"ClusterFanout", RESULTS_LABEL, -1},
+        {"Channel", RESULTS_LABEL, -1},
+        {"ChannelPlan", RESULTS_LABEL, -1},
+        {"Mobility", RESULTS_LABEL, -1},
+        {"Scheduler", RESULTS_LABEL, -1},
+    };
+    return schema;
+}
+
+/**
+ * @brief Time-windowed telemetry metrics, written while the simulation runs.
+ *
+ * One row per flow and window, plus one aggregate row per cluster and window
+ * with SourceAddress 0.0.0.0. Rx counts, latency and throughput are taken
+ * over the packets received in the window, TxPackets over those sent in it.
+ */
+inline const std::vector<ResultsColumn>& WindowResultsSchema() {
+    static const std::vector<ResultsColumn> schema = {
+        {"RunNumber", RESULTS_U32, -1},
+        {"NodesPerCluster", RESULTS_U32, -1},
+        {"FollowerSpeed", RESULTS_F64, -1},
+        {"NoiseFactor", RESULTS_F64, -1},
+        {"PacketSize", RESULTS_U32, -1},
+        {"WindowStart_s", RESULTS_F64, -1},
+        {"WindowLength_s", RESULTS_F64, -1},
+        {"Cluster", RESULTS_U32, -1},
+        {"SourceAddress", RESULTS_IPV4, -1},
+        {"TxPackets", RESULTS_U32, -1},
+        {"RxPackets", RESULTS_U32, -1},
+        {"RxBytes", RESULTS_U64, -1},
+        {"PacketDeliveryRatio", RESULTS_F64, 2},
+        {"AvgLatency_ms", RESULTS_F64, 2},
+        {"Throughput_kbps", RESULTS_F64, 2},
+        {"OfferedRate_kbps", RESULTS_F64, -1},
+    };
+    return schema;
+}
+
+/**
+ * @brief Routing control overhead per node and run.
+ *
+ * Role is 0 for the super-leader, 1 for the other leaders and 2 for the
+ * followers; Address is the node's first non-loopback address. Message
+ * bytes are OLSR message sizes, ControlPackets and ControlBytes count
+ * whole control packets at the IP level, once per interface they are sent on.
+ * The columns from RunId on identify the run as in FlowResultsSchema.
+ */
+inline const std::vector<ResultsColumn>& NodeResultsSchema() {
+    static const std::vector<ResultsColumn> schema = {
+        {"RunNumber", RESULTS_U32, -1},
+        {"NodesPerCluster", RESULTS_U32, -1},
+        {"PacketSize", RESULTS_U32, -1},
+        {"OfferedRate_kbps", RESULTS_F64, -1},
+        {"NodeId", RESULTS_U32, -1},
+        {"Role", RESULTS_U32, -1},
+        {"Address", RESULTS_IPV4, -1},
+        {"HelloMessages", RESULTS_U64, -1},
+        {"HelloBytes", RESULTS_U64, -1},
+        {"TcMessages", RESULTS_U64, -1},
+        {"TcBytes", RESULTS_U64, -1},
+        {"HnaMessages", RESULTS_U64, -1},
+        {"HnaBytes", RESULTS_U64, -1},
+        {"ControlPackets", RESULTS_U64, -1},
+        {"ControlBytes", RESULTS_U64, -1},
+        {"RouteRecomputations", RESULTS_U64, -1},
+        {"RunId", RESULTS_U64, -1},
+        {"Routing", RESULTS_LABEL, -1},
+        {"ClusterFanout", RESULTS_LABEL, -1},
+        {"Channel", RESULTS_LABEL, -1},
+        {"ChannelPlan", RESULTS_LABEL, -1},
+        {"Mobility", RESULTS_LABEL, -1},
+        {"Scheduler", RESULTS_LABEL, -1},
+        {"SimTime", RESULTS_F64, -1},
+        {"AreaSize", RESULTS_F64, -1},
+        {"FollowerSpeed", RESULTS_F64, -1},
+        {"NoiseFactor", RESULTS_F64, -1},
+    };
+    return schema;
+}
+
+//================================================================================
+// 2. IN-MEMORY BLOCK
+//================================================================================
+
+/**
+ * @brief Rows of one run, kept column by column until they are appended.
+ */
+class ResultsBlock {
+public:
+    explicit ResultsBlock(const std::vector<ResultsColumn>& schema)
+        : m_schema(schema), m_columns(schema.size()), m_rows(0) {
+    }
+
+    void PutU32(uint32_t column, uint32_t value) {
+        Put(column, &value, sizeof(value));
+    }
+
+    void PutU64(uint32_t column, uint64_t value) {
+        Put(column, &value, sizeof(value));
+    }
+
+    void PutF64(uint32_t column, double value) {
+        Put(column, &value, sizeof(value));
+    }
+
+    /**
+     * @brief Stores at most RESULTS_LABEL_WIDTH bytes of `value`.
+     */
+    void PutLabel(uint32_t column, const std::string& value) {
+        char label[RESULTS_LABEL_WIDTH] = {};
+        std::memcpy(label, value.data(), value.size() < sizeof(label) ? value.size() : sizeof(label));
+        Put(column, label, sizeof(label));
+    }
+
+    /**
+     * @brief Closes the current row; returns false unless every column got exactly one value.
+     */
+    bool EndRow() {
+        ++m_rows;
+        for (uint32_t c = 0; c < m_columns.size(); ++c) {
+            if (m_columns[c].size() != static_cast<size_t>(m_rows) * ResultsColumnWidth(m_schema[c].type)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    uint32_t GetRowCount() const {
+        return m_rows;
+    }
+
+    /**
+     * @brief Sets `column` to `value` in every row added so far.
+     */
+    void FillF64(uint32_t column, double value) {
+        Fill(column, &value);
+    }
+
+    void FillU64(uint32_t column, uint64_t value) {
+        Fill(column, &value);
+    }
+
+    /**
+     * @brief Drops all rows, keeping the allocated capacity.
+     */
+    void Clear() {
+        for (std::vector<uint8_t>& column : m_columns) {
+            column.clear();
+        }
+        m_rows = 0;
+    }
+
+    const std::vector<ResultsColumn>& GetSchema() const {
+        return m_schema;
+    }
+
+    const std::vector<uint8_t>& GetColumn(uint32_t column) const {
+        return m_columns[column];
+    }
+
+    uint32_t GetU32(uint32_t column, uint32_t row) const {
+        uint32_t value;
+        std::memcpy(&value, m_columns[column].data() + static_cast<size_t>(row) * sizeof(value), sizeof(value));
+        return value;
+    }
+
+    uint64_t GetU64(uint32_t column, uint32_t row) const {
+        uint64_t value;
+        std::memcpy(&value, m_columns[column].data() + static_cast<size_t>(row) * sizeof(value), sizeof(value));
+        return value;
+    }
+
+    double GetF64(uint32_t column, uint32_t row) const {
+        double value;
+        std::memcpy(&value, m_columns[column].data() + static_cast<size_t>(row) * sizeof(value), sizeof(value));
+        return value;
+    }
+
+    std::string GetLabel(uint32_t column, uint32_t row) const {
+        const char* label = reinterpret_cast<const char*>(m_columns[column].data()) + static_cast<size_t>(row) * RESULTS_LABEL_WIDTH;
+        return std::string(label, strnlen(label, RESULTS_LABEL_WIDTH));
+    }
+
+    /**
+     * @brief Replaces the contents with `rows` rows read from a serialized payload.
+     */
+    void Load(uint32_t rows, const uint8_t* payload) {
+        m_rows = rows;
+        for (uint32_t c = 0; c < m_columns.size(); ++c) {
+            size_t bytes = static_cast<size_t>(rows) * ResultsColumnWidth(m_schema[c].type);
+            m_columns[c].assign(payload, payload + bytes);
+            payload += bytes;
+        }
+    }
+
+private:
+    void Fill(uint32_t column, const void* value) {
+        uint32_t width = ResultsColumnWidth(m_schema[column].type);
+        for (size_t offset = 0; offset + width <= m_columns[column].size(); offset += width) {
+            std::memcpy(m_columns[column].data() + offset, value, width);
+        }
+    }
+
+    void Put(uint32_t column, const void* value, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(value);
+        m_columns[column].insert(m_columns[column].end(), bytes, bytes + size);
+    }
+
+    std::vector<ResultsColumn> m_schema;
+    std::vector<std::vector<uint8_t>> m_columns;
+    uint32_t m_rows;
+};
+
+//================================================================================
+// 3. FILE FORMAT
+//================================================================================
+
+static const char RESULTS_MAGIC[8] = {'M', 'A', 'N', 'E', 'T', 'R', 'E', 'S'};
+static const uint32_t RESULTS_VERSION = 2; // 2 adds RESULTS_LABEL; version 1 files are still read
+static const uint32_t RESULTS_BLOCK_MAGIC = 0x314b4c42; // "BLK1"
+
+struct ResultsBlockHeader {
+    uint32_t magic;
+    uint32_t rowCount;
+    uint64_t payloadBytes;
+    uint64_t checksum;
+};
+
+inline uint64_t ResultsChecksum(const uint8_t* data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+inline uint64_t ResultsRowBytes(const std::vector<ResultsColumn>& schema) {
+    uint64_t bytes = 0;
+    for (const ResultsColumn& column : schema) {
+        bytes += ResultsColumnWidth(column.type);
+    }
+    return bytes;
+}
+
+/**
+ * @brief Reads the file header and column table; returns false if it is missing or malformed.
+ */
+inline bool ReadResultsSchema(FILE* file, std::vector<ResultsColumn>* schema) {
+    char magic[8];
+    uint32_t version = 0;
+    uint32_t columnCount = 0;
+    if (std::fread(magic, 1, sizeof(magic), file) != sizeof(magic) || std::memcmp(magic, RESULTS_MAGIC, sizeof(magic)) != 0
+        || std::fread(&version, sizeof(version), 1, file) != 1 || version == 0 || version > RESULTS_VERSION
+        || std::fread(&columnCount, sizeof(columnCount), 1, file) != 1) {
+        return false;
+    }
+    schema->clear();
+    for (uint32_t c = 0; c < columnCount; ++c) {
+        uint8_t type = 0;
+        int8_t precision = 0;
+        uint8_t nameLength = 0;
+        if (std::fread(&type, 1, 1, file) != 1 || std::fread(&precision, 1, 1, file) != 1
+            || std::fread(&nameLength, 1, 1, file) != 1) {
+            return false;
+        }
+        std::string name(nameLength, '\0');
+        if (nameLength > 0 && std::fread(&name[0], 1, nameLength, file) != nameLength) {
+            return false;
+        }
+        schema->push_back({name, static_cast<ResultsColumnType>(type), precision});
+    }
+    return true;
+}
+
+inline void WriteResultsSchema(FILE* file, const std::vector<ResultsColumn>& schema) {
+    uint32_t columnCount = schema.size();
+    std::fwrite(RESULTS_MAGIC, 1, sizeof(RESULTS_MAGIC), file);
+    std::fwrite(&RESULTS_VERSION, sizeof(RESULTS_VERSION), 1, file);
+    std::fwrite(&columnCount, sizeof(columnCount), 1, file);
+    for (const ResultsColumn& column : schema) {
+        uint8_t type = column.type;
+        uint8_t nameLength = column.name.size();
+        std::fwrite(&type, 1, 1, file);
+        std::fwrite(&column.precision, 1, 1, file);
+        std::fwrite(&nameLength, 1, 1, file);
+        std::fwrite(column.name.data(), 1, nameLength, file);
+    }
+}
+
+inline bool SameResultsSchema(const std::vector<ResultsColumn>& a, const std::vector<ResultsColumn>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t c = 0; c < a.size(); ++c) {
+        if (a[c].name != b[c].name || a[c].type != b[c].type || a[c].precision != b[c].precision) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Keeps a results file open for a sequence of block appends.
+ *
+ * Open() creates the file (with its schema) if needed. An existing file
+ * must have the same schema; its blocks are walked by their headers only (no
+ * checksum pass, so opening stays cheap on large files) and a torn last
+ * block is truncated. Each Append() then writes one block with a single
+ * write and flushes it.
+ */
+class ResultsAppender {
+public:
+    ResultsAppender() : m_file(nullptr) {
+    }
+
+    ResultsAppender(const ResultsAppender&) = delete;
+    ResultsAppender& operator=(const ResultsAppender&) = delete;
+
+    ~ResultsAppender() {
+        Close();
+    }
+
+    bool IsOpen() const {
+        return m_file != nullptr;
+    }
+
+    /**
+     * @return False with a message in `error` if the file cannot be used.
+     */
+    bool Open(const std::string& fileName, const std::vector<ResultsColumn>& schema, std::string* error) {
+        Close();
+        m_fileName = fileName;
+        m_schema = schema;
+        m_file = std::fopen(fileName.c_str(), "r+b");
+        if (m_file == nullptr) {
+            m_file = std::fopen(fileName.c_str(), "w+b");
+        }
+        if (m_file == nullptr) {
+            *error = "cannot open " + fileName;
+            return false;
+        }
+
+        std::fseek(m_file, 0, SEEK_END);
+        off_t fileSize = ftello(m_file);
+        std::rewind(m_file);
+        if (fileSize == 0) {
+            WriteResultsSchema(m_file, schema);
+            return std::fflush(m_file) == 0;
+        }
+        std::vector<ResultsColumn> existing;
+        if (!ReadResultsSchema(m_file, &existing) || !SameResultsSchema(existing, schema)) {
+            Close();
+            *error = fileName + " is not a results file with the expected columns";
+            return false;
+        }
+        uint64_t rowBytes = ResultsRowBytes(schema);
+        off_t end = ftello(m_file);
+        ResultsBlockHeader header;
+        while (std::fread(&header, sizeof(header), 1, m_file) == 1 && header.magic == RESULTS_BLOCK_MAGIC
+               && header.payloadBytes == header.rowCount * rowBytes
+               && end + static_cast<off_t>(sizeof(header) + header.payloadBytes) <= fileSize) {
+            end += sizeof(header) + header.payloadBytes;
+            fseeko(m_file, end, SEEK_SET);
+        }
+        if (end < fileSize && ftruncate(fileno(m_file), end) != 0) {
+            Close();
+            *error = "cannot truncate the incomplete last block of " + fileName;
+            return false;
+        }
+        fseeko(m_file, end, SEEK_SET);
+        return true;
+    }
+
+    bool Append(const ResultsBlock& block, std::string* error) {
+        if (!SameResultsSchema(block.GetSchema(), m_schema)) {
+            *error = "block does not match the columns of " + m_fileName;
+            return false;
+        }
+        ResultsBlockHeader header = {RESULTS_BLOCK_MAGIC, block.GetRowCount(), 0, 0};
+        m_record.resize(sizeof(header));
+        for (uint32_t c = 0; c < m_schema.size(); ++c) {
+            m_record.insert(m_record.end(), block.GetColumn(c).begin(), block.GetColumn(c).end());
+        }
+        header.payloadBytes = m_record.size() - sizeof(header);
+        header.checksum = ResultsChecksum(m_record.data() + sizeof(header), header.payloadBytes);
+        std::memcpy(m_record.data(), &header, sizeof(header));
+        if (std::fwrite(m_record.data(), 1, m_record.size(), m_file) != m_record.size() || std::fflush(m_file) != 0) {
+            *error = "short write to " + m_fileName;
+            return false;
+        }
+        return true;
+    }
+
+    void Close() {
+        if (m_file != nullptr) {
+            std::fclose(m_file);
+            m_file = nullptr;
+        }
+    }
+
+private:
+    FILE* m_file;
+    std::string m_fileName;
+    std::vector<ResultsColumn> m_schema;
+    std::vector<uint8_t> m_record;
+};
+
+/**
+ * @brief Appends `block` to `fileName` (see ResultsAppender).
+ *
+ * @return False with a message in `error` if the file cannot be used.
+ */
+inline bool AppendResultsBlock(const std::string& fileName, const ResultsBlock& block, std::string* error) {
+    ResultsAppender appender;
+    return appender.Open(fileName, block.GetSchema(), error) && appender.Append(block, error);
+}
+
+//================================================================================
+// 4. READER
+//================================================================================
+
+/**
+ * @brief Sequential block reader; stops at the first torn or corrupt block.
+ */
+class ResultsFileReader {
+public:
+    ResultsFileReader() : m_file(nullptr), m_corrupt(false) {
+    }
+
+    ResultsFileReader(const ResultsFileReader&) = delete;
+    ResultsFileReader& operator=(const ResultsFileReader&) = delete;
+
+    ~ResultsFileReader() {
+        if (m_file != nullptr) {
+            std::fclose(m_file);
+        }
+    }
+
+    bool Open(const std::string& fileName, std::string* error) {
+        m_file = std::fopen(fileName.c_str(), "rb");
+        if (m_file == nullptr) {
+            *error = "cannot open " + fileName;
+            return false;
+        }
+        if (!ReadResultsSchema(m_file, &m_schema)) {
+            *error = fileName + " is not a results file";
+            return false;
+        }
+        return true;
+    }
+
+    const std::vector<ResultsColumn>& GetSchema() const {
+        return m_schema;
+    }
+
+    /**
+     * @brief True if reading stopped at a block whose checksum did not match.
+     */
+    bool IsCorrupt() const {
+        return m_corrupt;
+    }
+
+    /**
+     * @brief Loads the next complete block into `block`; false at the end of the valid data.
+     */
+    bool NextBlock(ResultsBlock* block) {
+        ResultsBlockHeader header;
+        if (std::fread(&header, sizeof(header), 1, m_file) != 1 || header.magic != RESULTS_BLOCK_MAGIC
+            || header.payloadBytes != header.rowCount * ResultsRowBytes(m_schema)) {
+            return false;
+        }
+        m_payload.resize(header.payloadBytes);
+        if (header.payloadBytes > 0 && std::fread(m_payload.data(), 1, header.payloadBytes, m_file) != header.payloadBytes) {
+            return false; // Torn last block
+        }
+        if (ResultsChecksum(m_payload.data(), m_payload.size()) != header.checksum) {
+            m_corrupt = true;
+            return false;
+        }
+        block->Load(header.rowCount, m_payload.data());
+        return true;
+    }
+
+private:
+    FILE* m_file;
+    std::vector<ResultsColumn> m_schema;
+    std::vector<uint8_t> m_payload;
+    bool m_corrupt;
+};
+
+#endif // MANET_RESULTS_H